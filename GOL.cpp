@@ -39,23 +39,71 @@
 #include "UnicornHD.h"
 
 /***** Global Constants *****/
+//Each row of cells is held in one word, with a bit for each cell. A 32 bit row type allows
+//virtual grids of up to 32x32 cells, of which the middle 16x16 cells are shown.
+typedef uint16_t CellRow;
 static uint8_t const gridSize = 16;
+static uint8_t const displaySize = 16;
+static uint8_t const displayOffset = (gridSize - displaySize) / 2;
+static CellRow const rowMask = (CellRow)~(CellRow)0 >> (8 * sizeof(CellRow) - gridSize);
 static uint8_t const maxBrightness = 128;
 static uint8_t const maxGap = 24;
+static uint8_t const popHistorySize = 48;
+
+static_assert(gridSize <= 8 * sizeof(CellRow), "gridSize must fit in a CellRow");
+static_assert(gridSize >= displaySize, "gridSize must be at least as big as the display");
+
+//Fixed patterns, as rows from the top down. X marks a live cell.
+static const char* const pattern1[] = {
+  "................",
+  "..........XX....",
+  "..........XX....",
+  ".........X......",
+  "..........XXX...",
+  "..........XXX...",
+  "................",
+  "................",
+  "................",
+  "..........XXX...",
+  "..........XXX...",
+  ".........X......",
+  "..........XX....",
+  "..........XX....",
+  "................",
+  "................" };
+
+static const char* const pattern2[] = {
+  "................",
+  "................",
+  "....X.......X...",
+  "...XXX.....XXX..",
+  "................",
+  "................",
+  "................",
+  "................",
+  "................",
+  "................",
+  "................",
+  "................",
+  "................",
+  "...XXX.....XXX..",
+  "....X.......X...",
+  "................" };
 
 /***** Global Variables *****/
 UnicornHD unicorn;
 
-bool cells[gridSize][gridSize] = {};
-bool cellsLast1[gridSize][gridSize] = {};
-bool cellsLast2[gridSize][gridSize] = {};
-bool cellsLast3[gridSize][gridSize] = {};
-bool cellsBorn[gridSize][gridSize] = {};
-bool cellsDying[gridSize][gridSize] = {};
-
-uint8_t alive = 0;
-uint8_t population[48] = {};
-uint8_t popCursor = 47; //Set to last position as gets incremented before use
+//Rows of cells from the bottom up, bit x of each row for column x
+CellRow cells[gridSize] = {};
+CellRow cellsLast1[gridSize] = {};
+CellRow cellsLast2[gridSize] = {};
+CellRow cellsLast3[gridSize] = {};
+CellRow cellsBorn[gridSize] = {};
+CellRow cellsDying[gridSize] = {};
+
+uint16_t alive = 0;
+uint16_t population[popHistorySize] = {};
+uint8_t popCursor = popHistorySize - 1; //Set to last position as gets incremented before use
 uint8_t unchangedCount = 0;
 uint8_t repeat2Count = 0;
 uint8_t repeat3Count = 0;
@@ -66,6 +114,15 @@ uint32_t iterationsMax = 0;
 
 CRGB cellColour;
 
+/***** Function Prototypes *****/
+void initialiseGrid(uint8_t pattern);
+void setPattern(const char* const rows[]);
+void findChanges();
+void fadeInChanges();
+void applyChanges();
+void updatePixels();
+uint8_t countCells(CellRow row);
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // SETUP
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -92,7 +149,6 @@ void setup()
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 void loop()
 {
-  int8_t x, y, xt, yt, xi, yi, neighbours;
   uint8_t maxRepeatsCount, maxContributor;
 
   //Serial.print("Start of loop ");
@@ -169,61 +225,7 @@ void loop()
   unicorn.Show();
   
   //Apply rules of Game of Life to determine cells dying and being born
-  for(y = 0; y < gridSize; ++y)
-  {
-    for(x = 0; x < gridSize; ++x)
-    {
-      //For each cell, count neighbours, including wrapping over grid edges
-      neighbours = -1;
-      for(xi = -1; xi < 2; ++xi)
-      {
-        xt = x + xi;
-        if (xt < 0)
-        {
-          xt += gridSize;
-        }
-        else if (xt >= gridSize)
-        {
-          xt -= gridSize;
-        }
-        for(yi = -1; yi < 2; ++yi)
-        {
-          yt = y + yi;
-          if (yt < 0)
-          {
-            yt += gridSize;
-          }
-          else if (yt >= gridSize)
-          {
-            yt -= gridSize;
-          }
-          if (cells[xt][yt])
-          {
-            ++neighbours;
-          }
-        }
-      }
-
-      //Reset changes arrays for this cell
-      cellsBorn[x][y] = false;
-      cellsDying[x][y] = false;
-      if ( (cells[x][y]) && (neighbours < 2) )
-      {
-        //Populated cell with too few neighbours, so it will die
-        cellsDying[x][y] = true; //Kill
-      }
-      else if ( (cells[x][y] == false) && (neighbours == 2) ) 
-      {
-        //Empty cell with exactly 3 neighbours (count = 2 as did not count itself so was initialised as -1)
-        cellsBorn[x][y] = true; //Spawn
-      }
-      else if ( (cells[x][y]) && (neighbours > 3) )
-      {
-        //Populated cell with too many neighbours, so it will die
-        cellsDying[x][y] = true; //Kill
-      }
-    }
-  }
+  findChanges();
 
   fadeInChanges();
   
@@ -246,9 +248,7 @@ void loop()
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 void initialiseGrid(uint8_t pattern)
 {
-  uint8_t x, y, col, idx;
-  const bool X = true;
-  const bool O = false;
+  uint8_t x, y, col;
 
   alive = 0;
   iterations = 0;
@@ -256,7 +256,7 @@ void initialiseGrid(uint8_t pattern)
   for (x = 0; x < maxGap; ++x) unchangedPopulation[x] = 0;
   repeat2Count = 0;
   repeat3Count = 0;
-  for (x = 0; x < 48; ++x) population[x] = 0;
+  for (x = 0; x < popHistorySize; ++x) population[x] = 0;
 
   col = random(0,6);
   switch(col)
@@ -281,6 +281,8 @@ void initialiseGrid(uint8_t pattern)
       break;
   }
 
+  for(y = 0; y < gridSize; ++y) cells[y] = 0;
+
   if (pattern == 0) {
     //Random
     for(y = 0; y < gridSize; ++y)
@@ -290,12 +292,7 @@ void initialiseGrid(uint8_t pattern)
         uint8_t randNumber = random(0, 100);
         if (randNumber < 15)
         {
-           cells[x][y] = true;
-           alive++;
-        }
-        else
-        {
-          cells[x][y] = false;
+           cells[y] |= (CellRow)1 << x;
         }
       }
     }
@@ -305,107 +302,96 @@ void initialiseGrid(uint8_t pattern)
     Serial.print("Fixed pattern: ");
     Serial.print(pattern);
     Serial.print(" ");
-    
-        uint8_t pattern1[] = {
-        O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,X,X,O,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,X,X,O,O,O,O,
-        O,O,O,O,O,O,O,O,O,X,O,O,O,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,X,X,X,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,X,X,X,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,X,X,X,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,X,X,X,O,O,O,
-        O,O,O,O,O,O,O,O,O,X,O,O,O,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,X,X,O,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,X,X,O,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O };
-
-        uint8_t pattern2[] = {
-        O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-        O,O,O,O,X,O,O,O,O,O,O,O,X,O,O,O,
-        O,O,O,X,X,X,O,O,O,O,O,X,X,X,O,O,
-        O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-        O,O,O,X,X,X,O,O,O,O,O,X,X,X,O,O,
-        O,O,O,O,X,O,O,O,O,O,O,O,X,O,O,O,
-        O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O };
         
     switch(pattern)
     {
       case 1:
-        
-        for(y = 0; y < gridSize; ++y)
-        {
-          for(x = 0; x < gridSize; ++x)
-          {
-            idx = (15 - y)*16 + x;
-            cells[x][y] = pattern1[idx];
-          }
-        }
+        setPattern(pattern1);
         Serial.print("Case 1: ");
         break;
         
       case 2:
+        setPattern(pattern2);
         Serial.print("Case 2: ");
-        
-        for(y = 0; y < gridSize; ++y)
-        {
-          for(x = 0; x < gridSize; ++x)
-          {
-            idx = (15 - y)*16 + x;
-            cells[x][y] = pattern2[idx];
-          }
-        }
-        
-        /*
-        cells[6][4] = true;
-        cells[4][5] = true;
-        cells[8][5] = true;
-        cells[9][6] = true;
-        cells[4][7] = true;
-        cells[9][7] = true;
-        cells[5][8] = true;
-        cells[6][8] = true;
-        cells[7][8] = true;
-        cells[8][8] = true;
-        cells[9][8] = true;
-        */
-        Serial.print("Case 2 end: ");
         break;
+
       default:
-        cells[7][6] = true;
-        cells[6][7] = true;
-        cells[8][7] = true;
-        cells[5][8] = true;
-        cells[9][8] = true;
+        cells[displayOffset + 6] |= (CellRow)1 << (displayOffset + 7);
+        cells[displayOffset + 7] |= ((CellRow)1 << (displayOffset + 6)) | ((CellRow)1 << (displayOffset + 8));
+        cells[displayOffset + 8] |= ((CellRow)1 << (displayOffset + 5)) | ((CellRow)1 << (displayOffset + 9));
         Serial.print("Case Default: ");
         break;
     }
+  }
 
-    //Count cells in pattern
-    for(y = 0; y < gridSize; ++y)
-    {
-      for(x = 0; x < gridSize; ++x)
-      {
-        if (cells[x][y]) alive++;
-      }
-    }
+  //Count cells in pattern
+  for(y = 0; y < gridSize; ++y) alive += countCells(cells[y]);
+
+  if (pattern != 0)
+  {
     Serial.print("Alive: ");
     Serial.println(alive);
   }
+}
+
+//Set cells from a 16x16 pattern given as rows from the top down, in the middle of the grid
+void setPattern(const char* const rows[])
+{
+  uint8_t x, y;
+
+  for(y = 0; y < 16; ++y)
+  {
+    for(x = 0; x < 16; ++x)
+    {
+      if (rows[15 - y][x] == 'X')
+        cells[displayOffset + y] |= (CellRow)1 << (displayOffset + x);
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Find cells being born and dying
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void findChanges()
+{
+  uint8_t y, i;
+
+  //All the cells in a row are worked out together. The 8 neighbours of each cell are added up
+  //in separate bit planes for the 1s, 2s, and 4 or more, wrapping over the grid edges.
+  for(y = 0; y < gridSize; ++y)
+  {
+    CellRow above = cells[(y + 1 < gridSize) ? y + 1 : 0];
+    CellRow row = cells[y];
+    CellRow below = cells[(y > 0) ? y - 1 : gridSize - 1];
+    CellRow neighbours[8];
+    uint8_t n = 0;
+
+    neighbours[n++] = above;
+    neighbours[n++] = below;
+    for (i = 0; i < 3; ++i)
+    {
+      CellRow r = (i == 0) ? above : ((i == 1) ? row : below);
+      //Cells to the left and right, rotating the row by one cell
+      neighbours[n++] = ((r << 1) | (r >> (gridSize - 1))) & rowMask;
+      neighbours[n++] = ((r >> 1) | (r << (gridSize - 1))) & rowMask;
+    }
 
+    CellRow ones = 0, twos = 0, fours = 0;
+    for (i = 0; i < 8; ++i)
+    {
+      CellRow carry = ones & neighbours[i];
+      ones ^= neighbours[i];
+      fours |= twos & carry;
+      twos ^= carry;
+    }
+
+    //Cells with exactly 3 neighbours are born or survive, and live cells with 2 survive
+    CellRow three = ones & twos & ~fours;
+    CellRow two = ~ones & twos & ~fours;
+    CellRow next = three | (two & row);
+    cellsBorn[y] = next & ~row;
+    cellsDying[y] = row & ~next;
+  }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -446,17 +432,19 @@ void fadeInChanges()
       colourD.blue = 0;
     }
     
-    for(y = 0; y < gridSize; ++y)
+    for(y = 0; y < displaySize; ++y)
     {
-      for(x = 0; x < gridSize; ++x)
+      CellRow born = cellsBorn[displayOffset + displaySize - 1 - y] >> displayOffset;
+      CellRow dying = cellsDying[displayOffset + displaySize - 1 - y] >> displayOffset;
+      for(x = 0; x < displaySize; ++x)
       {
         //Fade births up to green
-        if (cellsBorn[x][gridSize-1-y])
+        if ((born >> x) & 1)
         {
           unicorn.Pixels()[idx] = colourB;
         }
         //Fade dying to red
-        if (cellsDying[x][gridSize-1-y])
+        if ((dying >> x) & 1)
         {
           unicorn.Pixels()[idx] = colourD;
         }
@@ -473,7 +461,8 @@ void fadeInChanges()
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 void applyChanges()
 {
-  uint8_t x, y, changes, i, j, gap;
+  uint8_t y, i, j, gap;
+  uint16_t changes;
   int8_t popChk,prevPopChk;
   
   changes = 0;
@@ -482,35 +471,24 @@ void applyChanges()
   
   for(y = 0; y < gridSize; ++y)
   {
-    for(x = 0; x < gridSize; ++x)
-    {
-      //Update last 3 iterations history for this cell
-      cellsLast3[x][y] = cellsLast2[x][y];
-      cellsLast2[x][y] = cellsLast1[x][y];
-      cellsLast1[x][y] = cells[x][y];
-
-      if (cellsBorn[x][y])
-      {
-        cells[x][y] = true;
-        ++changes;
-        ++alive;
-      }
+    //Update last 3 iterations history for this row
+    cellsLast3[y] = cellsLast2[y];
+    cellsLast2[y] = cellsLast1[y];
+    cellsLast1[y] = cells[y];
+
+    //Births and deaths both flip the cell
+    cells[y] ^= cellsBorn[y] | cellsDying[y];
+    changes += countCells(cellsBorn[y]) + countCells(cellsDying[y]);
+    alive += countCells(cellsBorn[y]);
+    alive -= countCells(cellsDying[y]);
       
-      if (cellsDying[x][y]) 
-      {
-          cells[x][y] = false;
-          ++changes;
-          --alive;
-      }
-      
-      //Compare cell to state 2 and 3 iterations ago
-      if (cells[x][y] != cellsLast2[x][y]) compare2 = false;
-      if (cells[x][y] != cellsLast3[x][y]) compare3 = false;
-    }
+    //Compare row to state 2 and 3 iterations ago
+    if (cells[y] != cellsLast2[y]) compare2 = false;
+    if (cells[y] != cellsLast3[y]) compare3 = false;
   }
 
   popCursor++;
-  if (popCursor > 47) popCursor = 0;
+  if (popCursor > popHistorySize-1) popCursor = 0;
   population[popCursor] = alive;
   
   //Increment counter if no changes made
@@ -533,7 +511,7 @@ void applyChanges()
 
   //Increment counter of unchanging population size
   if (popCursor == 0)
-    popChk = 47;
+    popChk = popHistorySize-1;
   else
     popChk = popCursor - 1;
 
@@ -546,15 +524,15 @@ void applyChanges()
   bool gapCheck = false;
   for (gap = 4; gap < maxGap+1; ++gap)
   {
-    for (i = 1; i < 48/gap; ++i)
+    for (i = 1; i < popHistorySize/gap; ++i)
     {
       
       for (j = 0; j < gap; ++j)
       {
         popChk = popCursor - 1 - (gap * i) - j;
-        if (popChk < 0) popChk += 48;
+        if (popChk < 0) popChk += popHistorySize;
         prevPopChk = popChk + (gap * i);
-        if (prevPopChk > 47) prevPopChk -= 48;
+        if (prevPopChk > popHistorySize-1) prevPopChk -= popHistorySize;
         gapCheck = ( (population[popChk] > 0) && (population[popChk] == population[prevPopChk]) );
 
         if (gapCheck == false)
@@ -570,8 +548,9 @@ void applyChanges()
     if (gapCheck == true) break;
   }
 
+  //When no cycle repeats, gap is past the end of the counters so reset them all
   if (gapCheck == true) ++unchangedPopulation[gap-1];
-  else unchangedPopulation[gap-1] = 0;
+  else for (gap = 4; gap < maxGap+1; ++gap) unchangedPopulation[gap-1] = 0;
   
 }
 
@@ -584,11 +563,12 @@ void updatePixels()
   uint8_t x;
   uint8_t y;
 
-  for(y = 0; y < gridSize; ++y)
+  for(y = 0; y < displaySize; ++y)
   {
-    for(x = 0; x < gridSize; ++x)
+    CellRow row = cells[displayOffset + displaySize - 1 - y] >> displayOffset;
+    for(x = 0; x < displaySize; ++x)
     {
-      if (cells[x][gridSize-1-y])
+      if ((row >> x) & 1)
       {
          unicorn.Pixels()[idx] = cellColour;
       }
@@ -599,5 +579,11 @@ void updatePixels()
     }
   }
 }
+
+//Number of live cells in a row
+uint8_t countCells(CellRow row)
+{
+  return __builtin_popcount(row);
+}
+///////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
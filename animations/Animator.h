@@ -0,0 +1,34 @@
+/**************************************************************************************************
+ * Animator abstract class
+ *
+ * Common base class of the animator classes, so code which runs animations (such as the Playlist
+ * class) can hold any animator and run it one cycle (frame) at a time.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ANIMATOR_H
+#define ANIMATOR_H
+
+class Animator
+{
+    //functions
+    public:
+        virtual ~Animator() {}
+        virtual void runCycle() = 0;
+}; //Animator
+
+#endif
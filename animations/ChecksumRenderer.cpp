@@ -0,0 +1,82 @@
+/**************************************************************************************************
+ * Checksum Renderer class
+ *
+ * Frame buffer renderer with no display, which calculates a hash of every frame shown, using a
+ * seeded random number generator so runs can be repeated exactly.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ChecksumRenderer.h"
+#include "Log.h"
+
+// default constructor
+ChecksumRenderer::ChecksumRenderer(int width, int height, uint64_t seed)
+    : FrameBufferRenderer(width, height), randomState(seed), checksum(0), frames(0)
+{
+} //ChecksumRenderer
+
+// default destructor
+ChecksumRenderer::~ChecksumRenderer()
+{
+    logFlush();
+} //~ChecksumRenderer
+
+void ChecksumRenderer::msSleep(int delay_ms)
+{
+    //No display to wait for
+}
+
+void ChecksumRenderer::outputMessage(char msg[])
+{
+    //Messages are not part of the output being checked
+}
+
+//SplitMix64 generator, so results do not depend on the C library rand()
+uint16_t ChecksumRenderer::random_uint(uint16_t a, uint16_t b)
+{
+    uint64_t z = (randomState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return a + z % (b - a);
+}
+
+//Hash of the last frame shown
+uint64_t ChecksumRenderer::getChecksum()
+{
+    return checksum;
+}
+
+//Number of frames shown
+uint32_t ChecksumRenderer::getFrames()
+{
+    return frames;
+}
+
+//64 bit FNV-1a hash of the frame buffer
+void ChecksumRenderer::flushPixels()
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    const uint8_t* p = pixels;
+    const uint8_t* end = pixels + gridWidth * gridHeight * 3;
+    while (p < end) {
+        hash ^= *p++;
+        hash *= 0x100000001B3ULL;
+    }
+    checksum = hash;
+    frames++;
+}
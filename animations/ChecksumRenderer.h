@@ -0,0 +1,55 @@
+/**************************************************************************************************
+ * Checksum Renderer class
+ *
+ * Frame buffer renderer with no display, which calculates a 64 bit FNV-1a hash of every frame
+ * shown. Random numbers come from its own generator started from a given seed, so an animator
+ * run with the same seed always produces the same sequence of frames on any platform. This
+ * allows changes to an animator to be checked against checksums recorded from an earlier
+ * version (see golden.cpp). Sleeps are skipped and messages are discarded.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHECKSUMRENDERER_H
+#define CHECKSUMRENDERER_H
+
+#include "FrameBufferRenderer.h"
+
+class ChecksumRenderer : public FrameBufferRenderer
+{
+    //variables
+    public:
+    protected:
+    private:
+        uint64_t randomState;
+        uint64_t checksum;
+        uint32_t frames;
+
+    //functions
+    public:
+        ChecksumRenderer(int, int, uint64_t);
+        virtual ~ChecksumRenderer();
+        virtual void msSleep(int);
+        virtual void outputMessage(char[]);
+        virtual uint16_t random_uint(uint16_t,uint16_t);
+        uint64_t getChecksum();
+        uint32_t getFrames();
+    protected:
+        virtual void flushPixels();
+    private:
+}; //ChecksumRenderer
+
+#endif
@@ -0,0 +1,106 @@
+/**************************************************************************************************
+ * Frame Buffer Renderer abstract class
+ *
+ * A renderer which keeps the colour of every pixel in a memory buffer, so animations can draw a
+ * whole frame before it is output to the display. Animator classes can use it like any other
+ * renderer via setPixel, or write directly into the buffer returned by getPixels for speed.
+ * Implementations provide the flushPixels method to copy the finished frame to the hardware.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FrameBufferRenderer.h"
+
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// default constructor
+FrameBufferRenderer::FrameBufferRenderer(int width, int height, int maxBrightness)
+    : RGBMatrixRenderer(width, height, maxBrightness)
+{
+    pixels = new uint8_t[width * height * 3];
+    clearPixels();
+} //FrameBufferRenderer
+
+// default destructor
+FrameBufferRenderer::~FrameBufferRenderer()
+{
+    delete [] pixels;
+} //~FrameBufferRenderer
+
+void FrameBufferRenderer::setPixel(int x, int y, uint8_t r, uint8_t g, uint8_t b)
+{
+    uint8_t* p = pixels + (y * gridWidth + x) * 3;
+    p[0] = r;
+    p[1] = g;
+    p[2] = b;
+}
+
+void FrameBufferRenderer::showPixels()
+{
+    flushPixels();
+    if (getDecay() > 0)
+        fadePixels(getDecay());
+}
+
+uint8_t* FrameBufferRenderer::getPixels()
+{
+    return pixels;
+}
+
+void FrameBufferRenderer::clearPixels()
+{
+    memset(pixels, 0, gridWidth * gridHeight * 3);
+}
+
+//Fade every pixel towards black by amount/256 of its brightness. Runs 16 bytes at a time with
+//NEON or SSE2 where available.
+void FrameBufferRenderer::fadePixels(uint8_t amount)
+{
+    if (amount == 0) return;
+    uint8_t keep = 256 - amount;
+    int size = gridWidth * gridHeight * 3;
+    uint8_t* p = pixels;
+    int i = 0;
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    uint8x8_t k = vdup_n_u8(keep);
+    for (; i + 16 <= size; i += 16, p += 16) {
+        uint8x16_t v = vld1q_u8(p);
+        uint8x8_t lo = vshrn_n_u16(vmull_u8(vget_low_u8(v), k), 8);
+        uint8x8_t hi = vshrn_n_u16(vmull_u8(vget_high_u8(v), k), 8);
+        vst1q_u8(p, vcombine_u8(lo, hi));
+    }
+#elif defined(__SSE2__)
+    __m128i k = _mm_set1_epi16(keep);
+    __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= size; i += 16, p += 16) {
+        __m128i v = _mm_loadu_si128((__m128i*)p);
+        __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(v, zero), k), 8);
+        __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(v, zero), k), 8);
+        _mm_storeu_si128((__m128i*)p, _mm_packus_epi16(lo, hi));
+    }
+#endif
+
+    for (; i < size; i++, p++) {
+        *p = (*p * keep) >> 8;
+    }
+}
@@ -0,0 +1,53 @@
+/**************************************************************************************************
+ * Frame Buffer Renderer abstract class
+ *
+ * A renderer which keeps the colour of every pixel in a memory buffer, so animations can draw a
+ * whole frame before it is output to the display. Animator classes can use it like any other
+ * renderer via setPixel, or write directly into the buffer returned by getPixels for speed.
+ * Implementations provide the flushPixels method to copy the finished frame to the hardware.
+ * If a decay is set, the whole buffer is faded after each frame is shown, giving fading trails.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMEBUFFERRENDERER_H
+#define FRAMEBUFFERRENDERER_H
+
+#include "RGBMatrixRenderer.h"
+
+class FrameBufferRenderer : public RGBMatrixRenderer
+{
+    //variables
+    public:
+    protected:
+        uint8_t* pixels; // 3 bytes (r,g,b) per pixel, row by row starting from y=0
+    private:
+
+    //functions
+    public:
+        FrameBufferRenderer(int, int, int=255);
+        virtual ~FrameBufferRenderer();
+        virtual void setPixel(int, int, uint8_t, uint8_t, uint8_t);
+        virtual void showPixels();
+        uint8_t* getPixels();
+        void clearPixels();
+        void fadePixels(uint8_t);
+    protected:
+        virtual void flushPixels() = 0;
+    private:
+}; //FrameBufferRenderer
+
+#endif
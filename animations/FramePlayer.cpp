@@ -0,0 +1,155 @@
+/**************************************************************************************************
+ * Frame Player animator class
+ *
+ * Plays back a file written by the RecordingRenderer class, showing one recorded frame per
+ * cycle.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FramePlayer.h"
+#include "RecordingRenderer.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// default constructor
+FramePlayer::FramePlayer(RGBMatrixRenderer &renderer_, const char* path)
+    : renderer(renderer_), data(NULL), size(0), pos(headerSize), width(0), height(0), frame(0)
+{
+    char msg[80];
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) == 0 && (size_t)st.st_size >= headerSize) {
+        void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            data = (const uint8_t*)map;
+            size = st.st_size;
+            madvise(map, size, MADV_SEQUENTIAL);
+        }
+    }
+    if (fd >= 0)
+        close(fd);
+
+    if (data && (memcmp(data, "RGBR", 4) != 0 || (data[4] | data[5]) == 0 || (data[6] | data[7]) == 0)) {
+        munmap((void*)data, size);
+        data = NULL;
+    }
+    if (!data) {
+        snprintf(msg, sizeof(msg), "Unable to play recording file %s\n", path);
+        renderer.outputMessage(msg);
+        return;
+    }
+
+    width = data[4] | (data[5] << 8);
+    height = data[6] | (data[7] << 8);
+    snprintf(msg, sizeof(msg), "Playing %dx%d recording\n", width, height);
+    renderer.outputMessage(msg);
+} //FramePlayer
+
+// default destructor
+FramePlayer::~FramePlayer()
+{
+    if (data)
+        munmap((void*)data, size);
+} //~FramePlayer
+
+//Run Cycle shows the next recorded frame
+void FramePlayer::runCycle()
+{
+    if (!data)
+        return;
+
+    //Start again from the beginning at the end of the file, or if the last frame was cut short.
+    //pos never passes size, so pos + 5 can't wrap, and the length is compared against what is left
+    if (pos + 5 > size) {
+        pos = headerSize;
+        frame = 0;
+        if (pos + 5 > size)
+            return;
+    }
+    const uint8_t* p = data + pos;
+    uint8_t type = p[0];
+    uint32_t length = p[1] | (p[2] << 8) | (p[3] << 16) | ((uint32_t)p[4] << 24);
+    if (length > size - pos - 5) {
+        pos = size;
+        return;
+    }
+    p += 5;
+    const uint8_t* end = p + length;
+
+    uint32_t numPixels = width * height;
+    if (type == RecordingRenderer::FRAME_KEY) {
+        for (uint32_t i=0; i<numPixels && p+3 <= end; i++, p+=3)
+            setPixel(i, p);
+    }
+    else {
+        uint32_t i = 0;
+        while (p < end) {
+            uint32_t skip, count;
+            p = getCount(p, end, skip);
+            if (p)
+                p = getCount(p, end, count);
+            //Stop at a count cut short by the end of the frame, or running past the last pixel
+            if (!p || skip > numPixels - i || count > numPixels - i - skip)
+                break;
+            i += skip;
+            for (uint32_t n=0; n<count && p+3 <= end; n++, i++, p+=3)
+                setPixel(i, p);
+        }
+    }
+
+    renderer.showPixels();
+    pos += 5 + length;
+    frame++;
+}
+
+bool FramePlayer::isOpen()
+{
+    return data != NULL;
+}
+
+//Number of frames shown since the start of the recording
+uint32_t FramePlayer::getFrame()
+{
+    return frame;
+}
+
+//Set pixel i of the recorded frame, clipping to the renderer grid
+void FramePlayer::setPixel(uint32_t i, const uint8_t* rgb)
+{
+    int x = i % width;
+    int y = i / width;
+    if (x < renderer.getGridWidth() && y < renderer.getGridHeight())
+        renderer.setPixel(x, y, rgb[0], rgb[1], rgb[2]);
+}
+
+//Read a count written as 7 bits per byte, low bits first. Returns NULL if the count does not
+//end before end, or is too long to be a 32 bit count.
+const uint8_t* FramePlayer::getCount(const uint8_t* p, const uint8_t* end, uint32_t &count)
+{
+    count = 0;
+    for (int shift = 0; p < end && shift < 32; shift += 7) {
+        uint8_t byte = *p++;
+        count |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return p;
+    }
+    return NULL;
+}
@@ -0,0 +1,63 @@
+/**************************************************************************************************
+ * Frame Player animator class
+ *
+ * Plays back a file written by the RecordingRenderer class, showing one recorded frame per cycle
+ * and starting again from the beginning when the end of the file is reached. The file is memory
+ * mapped and only the pixels which changed in each frame are set on the renderer, so playback
+ * costs almost nothing however expensive the recorded animation was to generate.
+ *
+ * Uses POSIX memory mapping so is not available on Arduino builds.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMEPLAYER_H
+#define FRAMEPLAYER_H
+
+#include <stddef.h>
+
+#include "RGBMatrixRenderer.h"
+#include "Animator.h"
+
+class FramePlayer : public Animator
+{
+    //variables
+    public:
+    protected:
+    private:
+        static size_t const headerSize = 8;
+        RGBMatrixRenderer &renderer;
+        const uint8_t* data;  // Mapped file
+        size_t size;
+        size_t pos;           // Offset of next frame
+        int width;            // Recorded frame size
+        int height;
+        uint32_t frame;
+
+    //functions
+    public:
+        FramePlayer(RGBMatrixRenderer&, const char*);
+        ~FramePlayer();
+        void runCycle();
+        bool isOpen();
+        uint32_t getFrame();
+    protected:
+    private:
+        void setPixel(uint32_t, const uint8_t*);
+        static const uint8_t* getCount(const uint8_t*, const uint8_t*, uint32_t&);
+}; //FramePlayer
+
+#endif
@@ -0,0 +1,114 @@
+/**************************************************************************************************
+ * Frame Timer class
+ *
+ * Measures how long each named phase of an animator takes per frame, and periodically reports
+ * percentile times of each phase and of whole frames.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FrameTimer.h"
+
+#if defined(FRAME_TIMING)
+
+#include <string.h>
+
+// default constructor
+FrameTimer::FrameTimer(RGBMatrixRenderer &renderer_, const char* const* names_, uint8_t numPhases_, uint32_t reportFrames_)
+    : renderer(renderer_), names(names_), numPhases(numPhases_), reportFrames(reportFrames_), frames(0)
+{
+    if (numPhases > maxPhases)
+        numPhases = maxPhases;
+    memset(frameNanos, 0, sizeof(frameNanos));
+    memset(histogram, 0, sizeof(histogram));
+    frameStarted = clock::now();
+} //FrameTimer
+
+void FrameTimer::start(uint8_t phase)
+{
+    started[phase] = clock::now();
+}
+
+void FrameTimer::stop(uint8_t phase)
+{
+    frameNanos[phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - started[phase]).count();
+}
+
+//Add the phase times of this frame, and the time since the last frame ended, to the histograms
+void FrameTimer::endFrame()
+{
+    clock::time_point now = clock::now();
+    for (uint8_t p=0; p<numPhases; p++) {
+        histogram[p][bucket(frameNanos[p])]++;
+        frameNanos[p] = 0;
+    }
+    histogram[maxPhases][bucket(std::chrono::duration_cast<std::chrono::nanoseconds>(now - frameStarted).count())]++;
+    frameStarted = now;
+
+    frames++;
+    if (frames >= reportFrames) {
+        report();
+        frames = 0;
+        memset(histogram, 0, sizeof(histogram));
+        //Don't count the time taken to report in the next frame
+        frameStarted = clock::now();
+    }
+}
+
+void FrameTimer::report()
+{
+    char msg[120];
+    snprintf(msg, sizeof(msg), "Timing over %u frames, p50/p95/p99 in us:\n", frames);
+    renderer.outputMessage(msg);
+    for (uint8_t p=0; p<=numPhases; p++) {
+        uint8_t h = (p < numPhases) ? p : maxPhases;
+        snprintf(msg, sizeof(msg), "  %-10s %9.1f %9.1f %9.1f\n", (p < numPhases) ? names[p] : "frame",
+                 percentile(h, 50) / 1000.0, percentile(h, 95) / 1000.0, percentile(h, 99) / 1000.0);
+        renderer.outputMessage(msg);
+    }
+}
+
+//Lower bound of the bucket holding the given percentile of frames
+uint64_t FrameTimer::percentile(uint8_t h, uint8_t percent)
+{
+    uint32_t target = ((uint64_t)frames * percent + 99) / 100;
+    uint32_t count = 0;
+    for (uint16_t b=0; b<numBuckets; b++) {
+        count += histogram[h][b];
+        if (count >= target && count > 0)
+            return bucketValue(b);
+    }
+    return 0;
+}
+
+//Buckets are exact below 8ns, then split each power of 2 into 8 steps
+uint16_t FrameTimer::bucket(uint64_t nanos)
+{
+    if (nanos < 8)
+        return nanos;
+    uint8_t msb = 63 - __builtin_clzll(nanos);
+    return (msb - 2) * 8 + ((nanos >> (msb - 3)) & 7);
+}
+
+uint64_t FrameTimer::bucketValue(uint16_t b)
+{
+    if (b < 8)
+        return b;
+    uint8_t msb = b / 8 + 2;
+    return (uint64_t)(8 + b % 8) << (msb - 3);
+}
+
+#endif
@@ -0,0 +1,94 @@
+/**************************************************************************************************
+ * Frame Timer class
+ *
+ * Measures how long each named phase of an animator takes per frame, using the steady clock, and
+ * periodically reports the 50th, 95th and 99th percentile times of each phase and of whole frames
+ * through the renderer outputMessage method.
+ *
+ * Timing is only compiled in when FRAME_TIMING is defined (build with 'make TIMING=1'), and is
+ * not available on Arduino builds. Animators use the TIMING_ macros below, which compile to
+ * nothing otherwise. The macros expect the animator to have a FrameTimer pointer called timer.
+ * The pointer is always declared, and left NULL without FRAME_TIMING, so the layout of the
+ * animator classes is the same whichever way each file was built.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMETIMER_H
+#define FRAMETIMER_H
+
+#if defined(ARDUINO)
+#undef FRAME_TIMING
+#endif
+
+#if defined(FRAME_TIMING)
+
+#include <chrono>
+
+#include "RGBMatrixRenderer.h"
+
+class FrameTimer
+{
+    //variables
+    public:
+        static uint8_t const maxPhases = 8;
+    protected:
+    private:
+        typedef std::chrono::steady_clock clock;
+        static uint16_t const numBuckets = 512; // 8 buckets per power of 2 nanoseconds
+        RGBMatrixRenderer &renderer;
+        const char* const* names;
+        uint8_t numPhases;
+        uint32_t reportFrames;
+        uint32_t frames;
+        clock::time_point started[maxPhases];
+        clock::time_point frameStarted;
+        uint64_t frameNanos[maxPhases];                  // Time in each phase so far this frame
+        uint32_t histogram[maxPhases + 1][numBuckets];   // Phase times per frame, then frame times
+
+    //functions
+    public:
+        FrameTimer(RGBMatrixRenderer&, const char* const*, uint8_t, uint32_t=300);
+        void start(uint8_t);
+        void stop(uint8_t);
+        void endFrame();
+    protected:
+    private:
+        void report();
+        uint64_t percentile(uint8_t, uint8_t);
+        static uint16_t bucket(uint64_t);
+        static uint64_t bucketValue(uint16_t);
+}; //FrameTimer
+
+#define TIMING_INIT(renderer, names, count) timer = new FrameTimer(renderer, names, count)
+#define TIMING_FREE()                        delete timer
+#define TIMING_START(phase)                  timer->start(phase)
+#define TIMING_STOP(phase)                   timer->stop(phase)
+#define TIMING_FRAME()                       timer->endFrame()
+
+#else
+
+class FrameTimer;
+
+#define TIMING_INIT(renderer, names, count) timer = NULL
+#define TIMING_FREE()
+#define TIMING_START(phase)
+#define TIMING_STOP(phase)
+#define TIMING_FRAME()
+
+#endif
+
+#endif
@@ -0,0 +1,115 @@
+/**************************************************************************************************
+ * Headless Renderer class
+ *
+ * Frame buffer renderer with no display, which writes every frame shown as a Y4M video stream or
+ * a sequence of binary PPM images.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HeadlessRenderer.h"
+#include "Log.h"
+
+#include <stdlib.h>
+
+// default constructor
+HeadlessRenderer::HeadlessRenderer(int width, int height, FILE* out_, uint8_t format_, int fps)
+    : FrameBufferRenderer(width, height), out(out_), format(format_), planes(NULL), frames(0)
+{
+    //Must be set before anything is written to the stream
+    buffer = new char[bufferSize];
+    setvbuf(out, buffer, _IOFBF, bufferSize);
+
+    if (format == FORMAT_Y4M) {
+        planes = new uint8_t[width * height * 3];
+        fprintf(out, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", width, height, fps);
+    }
+} //HeadlessRenderer
+
+// default destructor
+HeadlessRenderer::~HeadlessRenderer()
+{
+    //Last log messages go out before the frame stream is flushed
+    logFlush();
+
+    //Flush and detach the buffer before it is freed, as the stream is owned by the caller
+    fflush(out);
+    setvbuf(out, NULL, _IONBF, 0);
+    delete [] buffer;
+    delete [] planes;
+} //~HeadlessRenderer
+
+void HeadlessRenderer::msSleep(int delay_ms)
+{
+    //No display to wait for
+}
+
+void HeadlessRenderer::outputMessage(char msg[])
+{
+    fputs(msg, stderr);
+}
+
+uint16_t HeadlessRenderer::random_uint(uint16_t a, uint16_t b)
+{
+    return a + rand()%(b-a);
+}
+
+//Number of frames written
+uint32_t HeadlessRenderer::getFrames()
+{
+    return frames;
+}
+
+void HeadlessRenderer::flushPixels()
+{
+    if (format == FORMAT_Y4M)
+        writeY4M();
+    else
+        writePPM();
+    frames++;
+}
+
+//Frame buffer rows start from the bottom of the display (y=0), while images start from the top,
+//so rows are written in reverse order
+void HeadlessRenderer::writePPM()
+{
+    int rowBytes = gridWidth * 3;
+    fprintf(out, "P6\n%d %d\n255\n", gridWidth, gridHeight);
+    for (int y=gridHeight-1; y>=0; y--)
+        fwrite(pixels + y * rowBytes, 1, rowBytes, out);
+}
+
+//Convert to BT.601 limited range YCbCr, as assumed for Y4M by ffmpeg
+void HeadlessRenderer::writeY4M()
+{
+    int numPixels = gridWidth * gridHeight;
+    uint8_t* py = planes;
+    uint8_t* pu = planes + numPixels;
+    uint8_t* pv = planes + numPixels * 2;
+    for (int y=gridHeight-1; y>=0; y--) {
+        const uint8_t* p = pixels + y * gridWidth * 3;
+        for (int x=0; x<gridWidth; x++, p+=3) {
+            int r = p[0];
+            int g = p[1];
+            int b = p[2];
+            *py++ = 16 + ((66*r + 129*g + 25*b + 128) >> 8);
+            *pu++ = 128 + ((-38*r - 74*g + 112*b + 128) >> 8);
+            *pv++ = 128 + ((112*r - 94*g - 18*b + 128) >> 8);
+        }
+    }
+    fputs("FRAME\n", out);
+    fwrite(planes, 1, numPixels * 3, out);
+}
@@ -0,0 +1,67 @@
+/**************************************************************************************************
+ * Headless Renderer class
+ *
+ * Frame buffer renderer with no display, which writes every frame shown to a file or stdout as
+ * a Y4M video stream (4:4:4 YCbCr) or a sequence of binary PPM images. Either can be piped into
+ * ffmpeg or image comparison tools, so animations can be run on machines without LED hardware.
+ * Sleeps are skipped, so animations run as fast as they can be simulated.
+ *
+ * Whole frames are written with one call to a large stdio buffer. PPM rows are written straight
+ * from the frame buffer, and Y4M frames are converted into a single plane buffer first.
+ *
+ * Uses stdio so is not available on Arduino builds.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HEADLESSRENDERER_H
+#define HEADLESSRENDERER_H
+
+#include <stdio.h>
+
+#include "FrameBufferRenderer.h"
+
+class HeadlessRenderer : public FrameBufferRenderer
+{
+    //variables
+    public:
+        static uint8_t const FORMAT_Y4M = 0;
+        static uint8_t const FORMAT_PPM = 1;
+    protected:
+    private:
+        static size_t const bufferSize = 1 << 20;
+        FILE* out;
+        uint8_t format;
+        char* buffer;     // stdio buffer for out
+        uint8_t* planes;  // Y, Cb and Cr planes of a Y4M frame
+        uint32_t frames;
+
+    //functions
+    public:
+        HeadlessRenderer(int, int, FILE*, uint8_t=FORMAT_Y4M, int=30);
+        virtual ~HeadlessRenderer();
+        virtual void msSleep(int);
+        virtual void outputMessage(char[]);
+        virtual uint16_t random_uint(uint16_t,uint16_t);
+        uint32_t getFrames();
+    protected:
+        virtual void flushPixels();
+    private:
+        void writeY4M();
+        void writePPM();
+}; //HeadlessRenderer
+
+#endif
@@ -0,0 +1,196 @@
+/**************************************************************************************************
+ * Layer Compositor and Layer Renderer classes
+ *
+ * Allows several animator classes to run on one display at the same time. Each animator is
+ * given its own LayerRenderer, which draws into a frame buffer for that layer. The compositor
+ * then blends all the layers, bottom to top, into the frame buffer of the output renderer in a
+ * single pass over the pixels.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LayerCompositor.h"
+#include "Log.h"
+
+#include <string.h>
+
+// default constructor
+LayerRenderer::LayerRenderer(RGBMatrixRenderer &output_)
+    : FrameBufferRenderer(output_.getGridWidth(), output_.getGridHeight(), output_.getMaxBrightness()),
+      output(output_), changed(true)
+{} //LayerRenderer
+
+// default destructor
+LayerRenderer::~LayerRenderer()
+{
+    //Messages are forwarded to the output renderer, so pass them on while this layer is whole
+    logFlush();
+} //~LayerRenderer
+
+void LayerRenderer::setPixel(int x, int y, uint8_t r, uint8_t g, uint8_t b)
+{
+    FrameBufferRenderer::setPixel(x, y, r, g, b);
+    changed = true;
+}
+
+void LayerRenderer::msSleep(int delay_ms)
+{
+    output.msSleep(delay_ms);
+}
+
+void LayerRenderer::outputMessage(char msg[])
+{
+    output.outputMessage(msg);
+}
+
+uint16_t LayerRenderer::random_uint(uint16_t a, uint16_t b)
+{
+    return output.random_uint(a, b);
+}
+
+//Layers are changed by setPixel or showPixels, or can be marked changed after writing directly
+//into the frame buffer
+bool LayerRenderer::hasChanged()
+{
+    return changed;
+}
+
+void LayerRenderer::setChanged(bool changed_)
+{
+    changed = changed_;
+}
+
+void LayerRenderer::flushPixels()
+{
+    //Nothing to output, the compositor reads the frame buffer
+    changed = true;
+}
+
+
+// default constructor
+LayerCompositor::LayerCompositor(FrameBufferRenderer &output_)
+    : output(output_), numLayers(0), baseLayers(0)
+{
+    base = new uint8_t[output.getGridWidth() * output.getGridHeight() * 3];
+} //LayerCompositor
+
+// default destructor
+LayerCompositor::~LayerCompositor()
+{
+    delete [] base;
+} //~LayerCompositor
+
+//Add a layer on top of those already added. Returns the layer number, or -1 if full.
+int LayerCompositor::addLayer(LayerRenderer &layer, uint8_t mode, uint8_t alpha_)
+{
+    if (numLayers >= maxLayers)
+        return -1;
+
+    layers[numLayers] = &layer;
+    numLayers++;
+    setBlend(numLayers - 1, mode, alpha_);
+    return numLayers - 1;
+}
+
+//Remove all layers
+void LayerCompositor::clearLayers()
+{
+    numLayers = 0;
+    baseLayers = 0;
+}
+
+//Set blend mode and alpha (0-255) for a layer
+void LayerCompositor::setBlend(int layer, uint8_t mode, uint8_t alpha_)
+{
+    blendMode[layer] = mode;
+    alpha[layer] = alpha_ + (alpha_ >> 7); // Scale to 0-256 so full alpha needs no division
+    layers[layer]->setChanged(true);
+}
+
+//Blend changed layers into the output frame buffer, and show it. Returns false without showing
+//the output if no layers changed.
+bool LayerCompositor::composite()
+{
+    //Find lowest changed layer
+    uint8_t first = numLayers;
+    for (uint8_t l=0; l<numLayers; l++) {
+        if (layers[l]->hasChanged()) {
+            first = l;
+            break;
+        }
+    }
+    if (first == numLayers)
+        return false;
+
+    //Start from the saved blend of unchanged layers if it covers layers up to the lowest
+    //changed one, otherwise start from black. Layers from start to first are unchanged, so if
+    //there are any the blend is saved again when reaching first.
+    uint8_t start = (first >= baseLayers) ? baseLayers : 0;
+    bool saveBase = (first > start);
+
+    int rowBytes = output.getGridWidth() * 3;
+    uint8_t* out = output.getPixels();
+    for (int y=0; y<output.getGridHeight(); y++) {
+        uint8_t* row = out + y * rowBytes;
+        uint8_t* baseRow = base + y * rowBytes;
+        if (start == 0)
+            memset(row, 0, rowBytes);
+        else
+            memcpy(row, baseRow, rowBytes);
+
+        for (uint8_t l=start; l<numLayers; l++) {
+            if (l == first && saveBase)
+                memcpy(baseRow, row, rowBytes);
+            blendRow(row, layers[l]->getPixels() + y * rowBytes, rowBytes, blendMode[l], alpha[l]);
+        }
+    }
+
+    baseLayers = first;
+    for (uint8_t l=first; l<numLayers; l++)
+        layers[l]->setChanged(false);
+
+    output.showPixels();
+    return true;
+}
+
+//Blend one row of a layer into the row of layers below
+void LayerCompositor::blendRow(uint8_t* dst, const uint8_t* src, int bytes, uint8_t mode, uint16_t a)
+{
+    switch (mode) {
+        case BLEND_ADD:
+            for (int i=0; i<bytes; i++) {
+                int v = dst[i] + ((src[i] * a) >> 8);
+                dst[i] = (v > 255) ? 255 : v;
+            }
+            break;
+        case BLEND_ALPHA:
+            for (int i=0; i<bytes; i+=3) {
+                if (src[i] | src[i+1] | src[i+2]) {
+                    dst[i]   += ((src[i]   - dst[i])   * (int)a) >> 8;
+                    dst[i+1] += ((src[i+1] - dst[i+1]) * (int)a) >> 8;
+                    dst[i+2] += ((src[i+2] - dst[i+2]) * (int)a) >> 8;
+                }
+            }
+            break;
+        case BLEND_MAX:
+            for (int i=0; i<bytes; i++) {
+                uint8_t v = (src[i] * a) >> 8;
+                if (v > dst[i])
+                    dst[i] = v;
+            }
+            break;
+    }
+}
@@ -0,0 +1,91 @@
+/**************************************************************************************************
+ * Layer Compositor and Layer Renderer classes
+ *
+ * Allows several animator classes to run on one display at the same time. Each animator is
+ * given its own LayerRenderer, which draws into a frame buffer for that layer. The compositor
+ * then blends all the layers, bottom to top, into the frame buffer of the output renderer in a
+ * single pass over the pixels, using an additive, alpha or maximum blend for each layer.
+ *
+ * Layers which have not been drawn to since the last frame are not blended again. The result of
+ * blending all the unchanged layers below the lowest changed layer is kept, so only the layers
+ * from the lowest changed layer up need to be blended each frame.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LAYERCOMPOSITOR_H
+#define LAYERCOMPOSITOR_H
+
+#include "FrameBufferRenderer.h"
+
+// Renderer for one layer. Drawing is kept in the layer frame buffer, while sleeps, messages and
+// random numbers are passed on to the output renderer.
+class LayerRenderer : public FrameBufferRenderer
+{
+    //variables
+    public:
+    protected:
+    private:
+        RGBMatrixRenderer &output;
+        bool changed;
+
+    //functions
+    public:
+        LayerRenderer(RGBMatrixRenderer&);
+        virtual ~LayerRenderer();
+        virtual void setPixel(int, int, uint8_t, uint8_t, uint8_t);
+        virtual void msSleep(int);
+        virtual void outputMessage(char[]);
+        virtual uint16_t random_uint(uint16_t,uint16_t);
+        bool hasChanged();
+        void setChanged(bool);
+    protected:
+        virtual void flushPixels();
+    private:
+}; //LayerRenderer
+
+class LayerCompositor
+{
+    //variables
+    public:
+        static uint8_t const BLEND_ADD   = 0; // Add layer to those below, scaled by alpha
+        static uint8_t const BLEND_ALPHA = 1; // Mix layer over those below by alpha, black is transparent
+        static uint8_t const BLEND_MAX   = 2; // Brightest of layer (scaled by alpha) and those below
+        static uint8_t const maxLayers = 8;
+    protected:
+    private:
+        FrameBufferRenderer &output;
+        LayerRenderer* layers[maxLayers];
+        uint8_t blendMode[maxLayers];
+        uint16_t alpha[maxLayers];  // 0-256
+        uint8_t numLayers;
+        uint8_t* base;              // Blend of the layers below baseLayers
+        uint8_t baseLayers;
+
+    //functions
+    public:
+        LayerCompositor(FrameBufferRenderer&);
+        ~LayerCompositor();
+        int addLayer(LayerRenderer&, uint8_t=BLEND_ADD, uint8_t=255);
+        void clearLayers();
+        void setBlend(int, uint8_t, uint8_t=255);
+        bool composite();
+    protected:
+    private:
+        void blendRow(uint8_t*, const uint8_t*, int, uint8_t, uint16_t);
+}; //LayerCompositor
+
+#endif
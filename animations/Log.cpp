@@ -0,0 +1,216 @@
+/**************************************************************************************************
+ * Logging ring buffer
+ *
+ * Messages are formatted into slots of a ring buffer by the threads logging them, and passed to
+ * the outputMessage method of their renderer by a background thread, started when the first
+ * message is logged. Slots are claimed with an atomic counter, so any thread can log without
+ * taking a lock. The writer thread polls the buffer, so logging makes no system calls.
+ *
+ * Messages are passed on while holding a lock, which logFlush and logForget also take. Both wait
+ * for messages still being formatted into slots claimed before they were called, so once a
+ * renderer's destructor has called logFlush, no message logged to it before then is left waiting.
+ *
+ * Not used on Arduino builds, where messages go straight to the renderer.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Log.h"
+#include "RGBMatrixRenderer.h"
+
+#if !defined(ARDUINO)
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+class LogBuffer
+{
+    //variables
+    public:
+    protected:
+    private:
+        static uint32_t const numSlots = 256;
+        static uint32_t const slotSize = 160;
+        char text[numSlots][slotSize];
+        RGBMatrixRenderer* target[numSlots];    // Renderer to pass each message to, NULL if forgotten
+        std::atomic<bool> ready[numSlots];
+        std::atomic<uint32_t> head;     // Next slot to claim
+        std::atomic<uint32_t> tail;     // Next slot to write out
+        std::atomic<uint32_t> dropped;
+        std::atomic<bool> stopping;
+        std::mutex writeLock;           // Held while passing messages on
+        std::thread writer;
+
+    //functions
+    public:
+        LogBuffer();
+        ~LogBuffer();
+        void add(RGBMatrixRenderer*, const char*, va_list);
+        void flush();
+        void forget(RGBMatrixRenderer*);
+    protected:
+    private:
+        void run();
+        uint32_t waitForClaimed();
+        bool writeReady();
+}; //LogBuffer
+
+// default constructor
+LogBuffer::LogBuffer()
+    : head(0), tail(0), dropped(0), stopping(false)
+{
+    for (uint32_t i=0; i<numSlots; i++)
+        ready[i] = false;
+    writer = std::thread(&LogBuffer::run, this);
+} //LogBuffer
+
+// default destructor
+LogBuffer::~LogBuffer()
+{
+    //Write out anything left before the program exits
+    stopping = true;
+    writer.join();
+} //~LogBuffer
+
+void LogBuffer::add(RGBMatrixRenderer* renderer, const char* format, va_list args)
+{
+    //Claim a slot, unless the writer thread has fallen a whole buffer behind
+    uint32_t slot = head.load(std::memory_order_relaxed);
+    do {
+        if (slot - tail.load(std::memory_order_acquire) >= numSlots) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    } while (!head.compare_exchange_weak(slot, slot + 1, std::memory_order_relaxed));
+
+    vsnprintf(text[slot % numSlots], slotSize, format, args);
+    target[slot % numSlots] = renderer;
+    ready[slot % numSlots].store(true, std::memory_order_release);
+}
+
+void LogBuffer::run()
+{
+    while (true) {
+        bool stop = stopping;
+        bool written;
+        {
+            std::lock_guard<std::mutex> guard(writeLock);
+            written = writeReady();
+        }
+        if (!written) {
+            if (stop)
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+}
+
+//Pass on messages which are ready, in order. Returns false if there were none. Called with
+//writeLock held.
+bool LogBuffer::writeReady()
+{
+    bool written = false;
+    uint32_t slot = tail.load(std::memory_order_relaxed);
+    while (ready[slot % numSlots].load(std::memory_order_acquire)) {
+        RGBMatrixRenderer* renderer = target[slot % numSlots];
+        if (renderer) {
+            //Report any messages lost while the buffer was full to the next renderer
+            uint32_t lost = dropped.exchange(0, std::memory_order_relaxed);
+            if (lost > 0) {
+                char msg[40];
+                snprintf(msg, sizeof(msg), "(%u log messages dropped)\n", lost);
+                renderer->outputMessage(msg);
+            }
+            renderer->outputMessage(text[slot % numSlots]);
+        }
+        ready[slot % numSlots].store(false, std::memory_order_relaxed);
+        slot++;
+        tail.store(slot, std::memory_order_release);
+        written = true;
+    }
+    return written;
+}
+
+//Wait for other threads to finish formatting messages into the slots claimed so far, and return
+//the end of those slots. Called with writeLock held, so the tail doesn't move.
+uint32_t LogBuffer::waitForClaimed()
+{
+    uint32_t end = head.load(std::memory_order_acquire);
+    for (uint32_t slot = tail.load(std::memory_order_relaxed); slot != end; slot++) {
+        while (!ready[slot % numSlots].load(std::memory_order_acquire))
+            std::this_thread::yield();
+    }
+    return end;
+}
+
+//Pass on all the messages logged so far, without waiting for the writer thread
+void LogBuffer::flush()
+{
+    std::lock_guard<std::mutex> guard(writeLock);
+    waitForClaimed();
+    writeReady();
+}
+
+//Drop the messages waiting for a renderer, so none are passed to it once it has gone
+void LogBuffer::forget(RGBMatrixRenderer* renderer)
+{
+    std::lock_guard<std::mutex> guard(writeLock);
+    uint32_t end = waitForClaimed();
+    for (uint32_t slot = tail.load(std::memory_order_relaxed); slot != end; slot++) {
+        if (target[slot % numSlots] == renderer)
+            target[slot % numSlots] = NULL;
+    }
+}
+
+//Created on first use, and destroyed (passing on any messages left) at exit
+static std::atomic<bool> started(false);
+
+static LogBuffer& logBuffer()
+{
+    static LogBuffer buffer;
+    started.store(true, std::memory_order_release);
+    return buffer;
+}
+
+void logMessage(RGBMatrixRenderer* renderer, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    logBuffer().add(renderer, format, args);
+    va_end(args);
+}
+
+//Pass on all the messages logged so far, on the calling thread. Renderers call this first in
+//their destructor, while they can still take their messages.
+void logFlush()
+{
+    if (started.load(std::memory_order_acquire))
+        logBuffer().flush();
+}
+
+//Called by the RGBMatrixRenderer destructor, to drop any messages left for a renderer which did
+//not flush them itself
+void logForget(RGBMatrixRenderer* renderer)
+{
+    if (started.load(std::memory_order_acquire))
+        logBuffer().forget(renderer);
+}
+
+#endif
@@ -0,0 +1,95 @@
+/**************************************************************************************************
+ * Logging macros
+ *
+ * Levelled logging for the animation classes, filtered at compile time. Messages below the
+ * level set by LOG_LEVEL (default LOG_LEVEL_INFO, set with e.g. 'make LOG_LEVEL=4') are removed
+ * by the compiler along with their arguments, so they cost nothing.
+ *
+ * Messages are formatted and passed to the outputMessage method of the renderer given, so each
+ * renderer decides whether and where they are shown. On Arduino builds this happens straight
+ * away. Elsewhere messages are formatted into a ring buffer along with their renderer, and a
+ * background thread passes them on, so logging never blocks the thread drawing the animation. If
+ * the ring buffer is full, messages are dropped and a count of dropped messages is passed on
+ * with the next message.
+ *
+ * The background thread calls outputMessage of renderers, so each renderer class calls logFlush()
+ * first in its destructor. That passes on the messages still waiting while the whole renderer is
+ * there to take them, before any of it is torn down. The RGBMatrixRenderer destructor then drops
+ * anything left, in case a renderer didn't.
+ *
+ *   LOG_INFO(renderer, "Pattern terminated after %lu iterations\n", (unsigned long)iterations);
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#elif defined(ARDUINO)
+#include "WProgram.h"
+#else
+#include <stdio.h>
+#endif
+
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Constant true if messages at level are compiled in, for skipping work only needed by them
+#define LOG_ENABLED(level) (LOG_LEVEL >= (level))
+
+#if defined(ARDUINO)
+
+//Messages are passed on as they are logged, so there is nothing waiting to flush
+static inline void logFlush() {}
+
+#define LOG_AT(level, renderer, ...) do { \
+        if (LOG_ENABLED(level)) { \
+            char logMsg_[80]; \
+            snprintf(logMsg_, sizeof(logMsg_), __VA_ARGS__); \
+            (renderer).outputMessage(logMsg_); \
+        } \
+    } while (0)
+
+#else
+
+class RGBMatrixRenderer;
+
+void logMessage(RGBMatrixRenderer*, const char*, ...) __attribute__((format(printf, 2, 3)));
+void logFlush();
+void logForget(RGBMatrixRenderer*);
+
+#define LOG_AT(level, renderer, ...) do { \
+        if (LOG_ENABLED(level)) \
+            logMessage(&(renderer), __VA_ARGS__); \
+    } while (0)
+
+#endif
+
+#define LOG_ERROR(renderer, ...) LOG_AT(LOG_LEVEL_ERROR, renderer, __VA_ARGS__)
+#define LOG_WARN(renderer, ...)  LOG_AT(LOG_LEVEL_WARN, renderer, __VA_ARGS__)
+#define LOG_INFO(renderer, ...)  LOG_AT(LOG_LEVEL_INFO, renderer, __VA_ARGS__)
+#define LOG_DEBUG(renderer, ...) LOG_AT(LOG_LEVEL_DEBUG, renderer, __VA_ARGS__)
+
+#endif
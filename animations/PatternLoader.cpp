@@ -0,0 +1,327 @@
+/**************************************************************************************************
+ * Pattern Loader class
+ *
+ * Reads Game of Life patterns in the standard RLE and Life 1.06 text formats, from memory mapped
+ * files or text in memory.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PatternLoader.h"
+
+#include <string.h>
+
+#if !defined(ARDUINO)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char life106Header[] = "#Life 1.06";
+
+// default constructor
+PatternLoader::PatternLoader()
+    : patterns(NULL), numPatterns(0), maxPatterns(0), maps(NULL), mapSizes(NULL), numMaps(0), maxMaps(0)
+{
+} //PatternLoader
+
+// default destructor
+PatternLoader::~PatternLoader()
+{
+#if !defined(ARDUINO)
+    for (size_t i=0; i<numMaps; i++)
+        munmap(maps[i], mapSizes[i]);
+#endif
+    delete [] maps;
+    delete [] mapSizes;
+    delete [] patterns;
+} //~PatternLoader
+
+//Load all the patterns in a file. Returns false if the file could not be read or held no patterns.
+bool PatternLoader::load(const char* path)
+{
+#if defined(ARDUINO)
+    return false;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    void* map = MAP_FAILED;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return false;
+
+    //Patterns without a name are named after the file
+    const char* name = strrchr(path, '/');
+    name = name ? name + 1 : path;
+    if (add((const char*)map, st.st_size, name) == 0) {
+        munmap(map, st.st_size);
+        return false;
+    }
+
+    //Keep the file mapped, as the patterns point into it
+    if (numMaps == maxMaps) {
+        maxMaps = maxMaps ? maxMaps * 2 : 8;
+        void** newMaps = new void*[maxMaps];
+        size_t* newSizes = new size_t[maxMaps];
+        for (size_t i=0; i<numMaps; i++) {
+            newMaps[i] = maps[i];
+            newSizes[i] = mapSizes[i];
+        }
+        delete [] maps;
+        delete [] mapSizes;
+        maps = newMaps;
+        mapSizes = newSizes;
+    }
+    maps[numMaps] = map;
+    mapSizes[numMaps] = st.st_size;
+    numMaps++;
+    return true;
+#endif
+}
+
+//Add all the patterns in a block of text, which must remain in memory while the loader is used.
+//Returns the number of patterns added.
+size_t PatternLoader::add(const char* text, size_t length, const char* name)
+{
+    size_t added = 0;
+    Pattern pattern;
+    size_t used;
+    while ((used = scan(text, length, pattern)) > 0) {
+        if (pattern.name[0] == 0 && name) {
+            strncpy(pattern.name, name, sizeof(pattern.name) - 1);
+            pattern.name[sizeof(pattern.name) - 1] = 0;
+        }
+        addPattern(pattern);
+        added++;
+        text += used;
+        length -= used;
+    }
+    return added;
+}
+
+size_t PatternLoader::getCount()
+{
+    return numPatterns;
+}
+
+const PatternLoader::Pattern& PatternLoader::getPattern(size_t i)
+{
+    return patterns[i];
+}
+
+void PatternLoader::addPattern(const Pattern &pattern)
+{
+    if (numPatterns == maxPatterns) {
+        maxPatterns = maxPatterns ? maxPatterns * 2 : 16;
+        Pattern* newPatterns = new Pattern[maxPatterns];
+        for (size_t i=0; i<numPatterns; i++)
+            newPatterns[i] = patterns[i];
+        delete [] patterns;
+        patterns = newPatterns;
+    }
+    patterns[numPatterns++] = pattern;
+}
+
+//Find the first pattern in a block of text and work out its size. Returns the number of bytes
+//up to the end of the pattern, or 0 if there are no more patterns in the text.
+size_t PatternLoader::scan(const char* text, size_t length, Pattern &pattern)
+{
+    pattern.name[0] = 0;
+    pattern.minX = 0;
+    pattern.minY = 0;
+
+    if (length >= sizeof(life106Header) - 1 && memcmp(text, life106Header, sizeof(life106Header) - 1) == 0)
+        return scanLife106(text, length, pattern);
+
+    //RLE comment lines come before the header. '#N' lines give the pattern name.
+    const char* p = text;
+    const char* end = text + length;
+    while (p < end) {
+        if (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+            p++;
+            continue;
+        }
+        if (*p != '#')
+            break;
+        const char* eol = (const char*)memchr(p, '\n', end - p);
+        if (eol == NULL)
+            eol = end;
+        if (p + 1 < eol && p[1] == 'N') {
+            const char* n = p + 2;
+            while (n < eol && *n == ' ')
+                n++;
+            size_t len = eol - n;
+            while (len > 0 && (n[len-1] == '\r' || n[len-1] == ' '))
+                len--;
+            if (len > sizeof(pattern.name) - 1)
+                len = sizeof(pattern.name) - 1;
+            memcpy(pattern.name, n, len);
+            pattern.name[len] = 0;
+        }
+        p = eol;
+    }
+
+    //Header line 'x = m, y = n, rule = B3/S23'. The rule is ignored.
+    if (p >= end || *p != 'x')
+        return 0;
+    const char* eol = (const char*)memchr(p, '\n', end - p);
+    if (eol == NULL)
+        eol = end;
+    const char* x = (const char*)memchr(p, '=', eol - p);
+    const char* y = x ? (const char*)memchr(x + 1, '=', eol - x - 1) : NULL;
+    if (y == NULL || getNumber(x + 1, eol, pattern.width) == NULL || getNumber(y + 1, eol, pattern.height) == NULL
+        || pattern.width < 0 || pattern.height < 0)
+        return 0;
+
+    //Cells run up to the '!'. Anything after it could be the next pattern of a collection.
+    pattern.format = FORMAT_RLE;
+    pattern.text = eol;
+    const char* last = (const char*)memchr(eol, '!', end - eol);
+    if (last == NULL)
+        last = end;
+    pattern.length = last - eol;
+    return (last < end) ? last + 1 - text : length;
+}
+
+//Life 1.06 files list the coordinates of each live cell, so the whole file is read to find the
+//bounding box
+size_t PatternLoader::scanLife106(const char* text, size_t length, Pattern &pattern)
+{
+    const char* p = text;
+    const char* end = text + length;
+    int minX = 0, minY = 0, maxX = -1, maxY = -1;
+    bool first = true;
+
+    pattern.format = FORMAT_LIFE106;
+    pattern.text = NULL;
+    while (p < end) {
+        const char* eol = (const char*)memchr(p, '\n', end - p);
+        if (eol == NULL)
+            eol = end;
+        if (pattern.text == NULL) {
+            //Skip header line
+            pattern.text = eol;
+        }
+        else if (*p != '#') {
+            int x, y;
+            const char* n = getNumber(p, eol, x);
+            if (n && getNumber(n, eol, y)) {
+                if (first || x < minX) minX = x;
+                if (first || x > maxX) maxX = x;
+                if (first || y < minY) minY = y;
+                if (first || y > maxY) maxY = y;
+                first = false;
+            }
+        }
+        p = eol + 1;
+    }
+
+    pattern.length = end - pattern.text;
+    pattern.minX = minX;
+    pattern.minY = minY;
+    pattern.width = maxX - minX + 1;
+    pattern.height = maxY - minY + 1;
+    return length;
+}
+
+//Pass each run of live cells in a pattern to a function. Returns the number of live cells.
+uint32_t PatternLoader::decode(const Pattern &pattern, PatternRunFn fn, void* context)
+{
+    if (pattern.format == FORMAT_LIFE106)
+        return decodeLife106(pattern, fn, context);
+
+    const char* p = pattern.text;
+    const char* end = p + pattern.length;
+    uint32_t cells = 0;
+    int x = 0;
+    int y = 0;
+    int count = 0;
+    for (; p < end; p++) {
+        char c = *p;
+        if (c >= '0' && c <= '9') {
+            if (count < 0x1000000)
+                count = count * 10 + (c - '0');
+            continue;
+        }
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+            continue;
+
+        int n = count ? count : 1;
+        count = 0;
+        if (c == 'b' || c == '.') {
+            x += n;
+        }
+        else if (c == '$') {
+            x = 0;
+            y += n;
+        }
+        else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+            //Any other state of a multi state pattern counts as alive
+            fn(context, x, y, n);
+            x += n;
+            cells += n;
+        }
+    }
+    return cells;
+}
+
+uint32_t PatternLoader::decodeLife106(const Pattern &pattern, PatternRunFn fn, void* context)
+{
+    const char* p = pattern.text;
+    const char* end = p + pattern.length;
+    uint32_t cells = 0;
+    while (p < end) {
+        const char* eol = (const char*)memchr(p, '\n', end - p);
+        if (eol == NULL)
+            eol = end;
+        int x, y;
+        const char* n;
+        if (*p != '#' && (n = getNumber(p, eol, x)) != NULL && getNumber(n, eol, y) != NULL) {
+            fn(context, x - pattern.minX, y - pattern.minY, 1);
+            cells++;
+        }
+        p = eol + 1;
+    }
+    return cells;
+}
+
+//Read a decimal number after optional spaces. Returns the position after it, or NULL if there is
+//no number before the end of the line.
+const char* PatternLoader::getNumber(const char* p, const char* end, int &value)
+{
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+    bool negative = (p < end && *p == '-');
+    if (negative)
+        p++;
+    if (p >= end || *p < '0' || *p > '9')
+        return NULL;
+    value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (value < 0x1000000)
+            value = value * 10 + (*p - '0');
+        p++;
+    }
+    if (negative)
+        value = -value;
+    return p;
+}
@@ -0,0 +1,89 @@
+/**************************************************************************************************
+ * Pattern Loader class
+ *
+ * Reads Game of Life patterns in the standard RLE and Life 1.06 text formats. Files are memory
+ * mapped and only scanned once when loaded, to find the size of each pattern. The cells are
+ * decoded from the mapped text each time a pattern is placed, and passed as runs of live cells to
+ * a callback so they can be written straight into the grid of the animator. A collection file can
+ * hold many RLE patterns one after another, each with its own header line.
+ *
+ * Patterns can also be scanned from text in memory, which is how the built in patterns of the
+ * GameOfLife class are stored. Loading files uses POSIX memory mapping, so is not available on
+ * Arduino builds.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATTERNLOADER_H
+#define PATTERNLOADER_H
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#elif defined(ARDUINO)
+#include "WProgram.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+//Called with each run of count live cells along a row, starting at x,y from the top left corner
+typedef void (*PatternRunFn)(void* context, int x, int y, int count);
+
+class PatternLoader
+{
+    //variables
+    public:
+        static uint8_t const FORMAT_RLE = 0;
+        static uint8_t const FORMAT_LIFE106 = 1;
+        struct Pattern {
+            const char* text;   // Cell data, after the header
+            size_t length;
+            uint8_t format;
+            int width;
+            int height;
+            int minX;           // Life 1.06 coordinates of the top left corner
+            int minY;
+            char name[32];
+        };
+    protected:
+    private:
+        Pattern* patterns;
+        size_t numPatterns;
+        size_t maxPatterns;
+        void** maps;            // Mapped files, unmapped by the destructor
+        size_t* mapSizes;
+        size_t numMaps;
+        size_t maxMaps;
+
+    //functions
+    public:
+        PatternLoader();
+        ~PatternLoader();
+        bool load(const char*);
+        size_t add(const char*, size_t, const char*);
+        size_t getCount();
+        const Pattern& getPattern(size_t);
+        static size_t scan(const char*, size_t, Pattern&);
+        static uint32_t decode(const Pattern&, PatternRunFn, void*);
+    protected:
+    private:
+        void addPattern(const Pattern&);
+        static size_t scanLife106(const char*, size_t, Pattern&);
+        static uint32_t decodeLife106(const Pattern&, PatternRunFn, void*);
+        static const char* getNumber(const char*, const char*, int&);
+}; //PatternLoader
+
+#endif
@@ -0,0 +1,117 @@
+/**************************************************************************************************
+ * Playlist class
+ *
+ * Runs a list of animators one after another on the same display, each for a set number of
+ * cycles, cross-fading from each animator to the next.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Playlist.h"
+
+// default constructor
+Playlist::Playlist(FrameBufferRenderer &output_, size_t arenaSize_, uint16_t fadeCycles_)
+    : output(output_), compositor(output_), arenaSize(arenaSize_), arenaUsed(0),
+      numItems(0), current(0), counter(0), fadeCycles(fadeCycles_), fadeLength(0), fadeCounter(0),
+      fadeStarted(false)
+{
+    arena = new uint8_t[arenaSize];
+} //Playlist
+
+// default destructor
+Playlist::~Playlist()
+{
+    //Objects in the arena were created with placement new, so call destructors directly
+    for (uint8_t i=0; i<numItems; i++) {
+        animators[i]->~Animator();
+        layers[i]->~LayerRenderer();
+    }
+    delete [] arena;
+} //~Playlist
+
+//Run Cycle is called once per frame of the animation
+void Playlist::runCycle()
+{
+    if (numItems == 0)
+        return;
+
+    animators[current]->runCycle();
+    layers[current]->showPixels();
+
+    //Cross-fade into the next animator over the last fadeCycles cycles of the current one. Each
+    //animator fades in and out within its own duration, so a fade takes at most half of the
+    //duration of either animator. The length is fixed once the fade has started.
+    uint8_t next = (current + 1) % numItems;
+    uint32_t duration = durations[current];
+    if (!fadeStarted) {
+        fadeLength = fadeCycles;
+        if (fadeLength > duration / 2)
+            fadeLength = duration / 2;
+        if (fadeLength > durations[next] / 2)
+            fadeLength = durations[next] / 2;
+    }
+    bool fading = (numItems > 1 && fadeLength > 0 && counter + fadeLength >= duration);
+    if (fading) {
+        if (!fadeStarted) {
+            //Next animator carries on from where it stopped, so its layer is kept as it was
+            compositor.addLayer(*layers[next], LayerCompositor::BLEND_ADD, 0);
+            fadeStarted = true;
+            fadeCounter = 0;
+        }
+        animators[next]->runCycle();
+        layers[next]->showPixels();
+        fadeCounter++;
+
+        uint8_t alpha = (uint32_t)fadeCounter * 255 / fadeLength;
+        compositor.setBlend(0, LayerCompositor::BLEND_ADD, 255 - alpha);
+        compositor.setBlend(1, LayerCompositor::BLEND_ADD, alpha);
+    }
+    compositor.composite();
+
+    counter++;
+    if (counter >= duration) {
+        //Cycles the next animator ran during the fade count towards its own duration
+        counter = fadeStarted ? fadeCounter : 0;
+        current = next;
+        start();
+    }
+}
+
+//Number of cycles to cross-fade between animators (0 switches without a fade)
+void Playlist::setFadeCycles(uint16_t cycles)
+{
+    fadeCycles = cycles;
+}
+
+//Index of the animator currently running (in the order added)
+uint8_t Playlist::getCurrent()
+{
+    return current;
+}
+
+//Show the current animator on its own
+void Playlist::start()
+{
+    compositor.clearLayers();
+    compositor.addLayer(*layers[current]);
+    fadeStarted = false;
+}
+
+//Round pos up to a multiple of alignment
+size_t Playlist::align(size_t pos, size_t alignment)
+{
+    return (pos + alignment - 1) / alignment * alignment;
+}
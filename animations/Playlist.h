@@ -0,0 +1,101 @@
+/**************************************************************************************************
+ * Playlist class
+ *
+ * Runs a list of animators one after another on the same display, each for a set number of
+ * cycles, cross-fading from each animator to the next. All the animators are created up front
+ * when they are added to the playlist, in memory taken from one block (arena) allocated when the
+ * playlist is created, so switching animations allocates no memory and there is no gap on the
+ * display.
+ *
+ * Each animator draws to its own LayerRenderer, and a LayerCompositor blends the current (and
+ * during a cross-fade, the next) layer into the output frame buffer renderer.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PLAYLIST_H
+#define PLAYLIST_H
+
+#if defined(ARDUINO)
+#include <new.h>
+#else
+#include <stddef.h>
+#include <new>
+#endif
+
+#include "Animator.h"
+#include "LayerCompositor.h"
+
+class Playlist
+{
+    //variables
+    public:
+        static uint8_t const maxItems = 16;
+    protected:
+    private:
+        FrameBufferRenderer &output;
+        LayerCompositor compositor;
+        uint8_t* arena;
+        size_t arenaSize;
+        size_t arenaUsed;
+        Animator* animators[maxItems];
+        LayerRenderer* layers[maxItems];
+        uint32_t durations[maxItems];
+        uint8_t numItems;
+        uint8_t current;
+        uint32_t counter;       // Cycles the current animator has run, including while fading in
+        uint16_t fadeCycles;
+        uint32_t fadeLength;    // Length of the fade into the next animator
+        uint32_t fadeCounter;   // Cycles since the fade into the next animator started
+        bool fadeStarted;
+
+    //functions
+    public:
+        Playlist(FrameBufferRenderer&, size_t, uint16_t=0);
+        ~Playlist();
+        void runCycle();
+        void setFadeCycles(uint16_t);
+        uint8_t getCurrent();
+
+        //Create an animator of type T in the arena, drawing to its own layer. The animator is
+        //constructed with the layer renderer followed by args. Returns NULL if the playlist or
+        //the arena is full.
+        template<typename T, typename... Args>
+        T* add(uint32_t cycles, Args... args)
+        {
+            size_t layerPos = align(arenaUsed, alignof(LayerRenderer));
+            size_t animatorPos = align(layerPos + sizeof(LayerRenderer), alignof(T));
+            if (numItems >= maxItems || animatorPos + sizeof(T) > arenaSize)
+                return NULL;
+            arenaUsed = animatorPos + sizeof(T);
+
+            LayerRenderer* layer = new (arena + layerPos) LayerRenderer(output);
+            T* animator = new (arena + animatorPos) T(*layer, args...);
+            layers[numItems] = layer;
+            animators[numItems] = animator;
+            durations[numItems] = cycles;
+            numItems++;
+            if (numItems == 1)
+                start();
+            return animator;
+        }
+    protected:
+    private:
+        static size_t align(size_t, size_t);
+        void start();
+}; //Playlist
+
+#endif
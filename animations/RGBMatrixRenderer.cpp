@@ -26,15 +26,20 @@
  */
 
 #include "RGBMatrixRenderer.h"
+#include "Log.h"
 
 // default constructor
 RGBMatrixRenderer::RGBMatrixRenderer(int width, int height, int maxBrightness)
-    : gridWidth(width), gridHeight(height), maxBrightness(maxBrightness)
+    : gridWidth(width), gridHeight(height), maxBrightness(maxBrightness), decay(0)
 {} //RGBMatrixRenderer
 
 // default destructor
 RGBMatrixRenderer::~RGBMatrixRenderer()
 {
+#if !defined(ARDUINO)
+    //Drop log messages still waiting to be passed to this renderer
+    logForget(this);
+#endif
 } //~RGBMatrixRenderer
 
 int RGBMatrixRenderer::getGridWidth()
@@ -52,6 +57,19 @@ uint8_t RGBMatrixRenderer::getMaxBrightness()
     return maxBrightness;
 }
 
+//Set amount (out of 256) every pixel fades by each time the pixels are shown, to leave fading
+//trails behind moving pixels. Only renderers which keep a frame buffer can apply the fade, but
+//animators can check getDecay to skip clearing pixels which will fade anyway.
+void RGBMatrixRenderer::setDecay(uint8_t decay_)
+{
+    decay = decay_;
+}
+
+uint8_t RGBMatrixRenderer::getDecay()
+{
+    return decay;
+}
+
 void RGBMatrixRenderer::setRandomColour()
 {
     // Init colour randomly
@@ -75,12 +93,8 @@ void RGBMatrixRenderer::setRandomColour()
             break;
         }
     }
-    
-    //This method for string concatenation was used as it compiles on both g++ on Linux
-    //and arduino platforms
-    char msg[32];
-    sprintf(msg, "New RGB colour  %d, %d, %d\n", r,  g, b);
-    outputMessage(msg);
+
+    LOG_DEBUG(*this, "New RGB colour  %d, %d, %d\n", r,  g, b);
 
 }
 
@@ -25,6 +25,9 @@
  * along with this software.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#ifndef RGBMATRIXRENDERER_H
+#define RGBMATRIXRENDERER_H
+
 #if defined(ARDUINO) && ARDUINO >= 100
 #include "Arduino.h"
 #elif defined(ARDUINO)
@@ -47,6 +50,7 @@ class RGBMatrixRenderer
         int gridHeight;
     private:
         int maxBrightness;
+        uint8_t decay;
         
     //functions
     public:
@@ -55,6 +59,8 @@ class RGBMatrixRenderer
         int getGridWidth();
         int getGridHeight();
         uint8_t getMaxBrightness();
+        void setDecay(uint8_t);
+        uint8_t getDecay();
         virtual void setPixel(int, int, uint8_t, uint8_t, uint8_t) = 0;
         virtual void showPixels() = 0;
         virtual void msSleep(int) = 0;
@@ -68,3 +74,5 @@ class RGBMatrixRenderer
     private:
         int newPosition(int,int,int,bool);
 }; //RGBMatrixRenderer
+
+#endif
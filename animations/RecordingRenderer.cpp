@@ -0,0 +1,147 @@
+/**************************************************************************************************
+ * Recording Renderer class
+ *
+ * Frame buffer renderer which writes every frame shown by an animator to a file as key frames
+ * and run length encoded deltas, and passes the frame on to an output renderer.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RecordingRenderer.h"
+#include "Log.h"
+
+#include <string.h>
+
+// default constructor
+RecordingRenderer::RecordingRenderer(RGBMatrixRenderer &output_, const char* path, uint16_t keyframeInterval_)
+    : FrameBufferRenderer(output_.getGridWidth(), output_.getGridHeight(), output_.getMaxBrightness()),
+      output(output_), keyframeInterval(keyframeInterval_), frame(0)
+{
+    int numPixels = gridWidth * gridHeight;
+    previous = new uint8_t[numPixels * 3];
+    //Worst case delta is every other pixel changed, with a 1 byte skip and 1 byte count per pixel
+    payload = new uint8_t[numPixels * 5 + 16];
+    if (keyframeInterval < 1)
+        keyframeInterval = 1;
+
+    file = fopen(path, "wb");
+    if (file) {
+        uint8_t header[8] = { 'R', 'G', 'B', 'R',
+                              (uint8_t)gridWidth, (uint8_t)(gridWidth >> 8),
+                              (uint8_t)gridHeight, (uint8_t)(gridHeight >> 8) };
+        fwrite(header, 1, sizeof(header), file);
+    }
+    else {
+        char msg[80];
+        snprintf(msg, sizeof(msg), "Unable to open recording file %s\n", path);
+        output.outputMessage(msg);
+    }
+} //RecordingRenderer
+
+// default destructor
+RecordingRenderer::~RecordingRenderer()
+{
+    logFlush();
+    if (file)
+        fclose(file);
+    delete [] previous;
+    delete [] payload;
+} //~RecordingRenderer
+
+bool RecordingRenderer::isOpen()
+{
+    return file != NULL;
+}
+
+void RecordingRenderer::msSleep(int delay_ms)
+{
+    output.msSleep(delay_ms);
+}
+
+void RecordingRenderer::outputMessage(char msg[])
+{
+    output.outputMessage(msg);
+}
+
+uint16_t RecordingRenderer::random_uint(uint16_t a, uint16_t b)
+{
+    return output.random_uint(a, b);
+}
+
+//Write the frame, and update the pixels of the output which changed
+void RecordingRenderer::flushPixels()
+{
+    int numPixels = gridWidth * gridHeight;
+    bool key = (frame % keyframeInterval == 0);
+
+    uint8_t* out = payload;
+    if (!key) {
+        int i = 0;
+        while (i < numPixels) {
+            int start = i;
+            while (i < numPixels && memcmp(pixels + i*3, previous + i*3, 3) == 0)
+                i++;
+            if (i == numPixels)
+                break;
+            int skip = i - start;
+            start = i;
+            while (i < numPixels && memcmp(pixels + i*3, previous + i*3, 3) != 0) {
+                output.setPixel(i % gridWidth, i / gridWidth, pixels[i*3], pixels[i*3+1], pixels[i*3+2]);
+                i++;
+            }
+            out = putCount(out, skip);
+            out = putCount(out, i - start);
+            memcpy(out, pixels + start*3, (i - start) * 3);
+            out += (i - start) * 3;
+        }
+        key = (out - payload >= numPixels * 3);
+    }
+
+    if (key) {
+        for (int i=0; i<numPixels; i++)
+            output.setPixel(i % gridWidth, i / gridWidth, pixels[i*3], pixels[i*3+1], pixels[i*3+2]);
+        writeFrame(FRAME_KEY, pixels, numPixels * 3);
+    }
+    else {
+        writeFrame(FRAME_DELTA, payload, out - payload);
+    }
+
+    memcpy(previous, pixels, numPixels * 3);
+    frame++;
+    output.showPixels();
+}
+
+void RecordingRenderer::writeFrame(uint8_t type, const uint8_t* data, uint32_t length)
+{
+    if (!file)
+        return;
+
+    uint8_t header[5] = { type, (uint8_t)length, (uint8_t)(length >> 8),
+                          (uint8_t)(length >> 16), (uint8_t)(length >> 24) };
+    fwrite(header, 1, sizeof(header), file);
+    fwrite(data, 1, length, file);
+}
+
+//Write a count as 7 bits per byte, low bits first, with the top bit set if more bytes follow
+uint8_t* RecordingRenderer::putCount(uint8_t* out, uint32_t count)
+{
+    while (count >= 0x80) {
+        *out++ = (count & 0x7F) | 0x80;
+        count >>= 7;
+    }
+    *out++ = count;
+    return out;
+}
@@ -0,0 +1,74 @@
+/**************************************************************************************************
+ * Recording Renderer class
+ *
+ * Frame buffer renderer which writes every frame shown by an animator to a file, and passes the
+ * frame on to an output renderer so the animation can be shown while it is recorded. The file
+ * can be played back with the FramePlayer animator class at almost no cost, so slow simulations
+ * can be recorded once and replayed at full speed.
+ *
+ * File format (all values little endian):
+ *   Header:  "RGBR", uint16 width, uint16 height
+ *   Frames:  uint8 type, uint32 payload length, payload
+ *     FRAME_KEY   - payload is all pixels as r,g,b bytes, row by row starting from y=0
+ *     FRAME_DELTA - payload is runs of pixels changed since the previous frame. Each run is the
+ *                   number of unchanged pixels to skip and the number of changed pixels (both as
+ *                   7 bits per byte variable length numbers), followed by r,g,b of the changed
+ *                   pixels
+ * A key frame is written every keyframeInterval frames, or whenever a delta would be larger.
+ *
+ * Uses stdio so is not available on Arduino builds.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RECORDINGRENDERER_H
+#define RECORDINGRENDERER_H
+
+#include <stdio.h>
+
+#include "FrameBufferRenderer.h"
+
+class RecordingRenderer : public FrameBufferRenderer
+{
+    //variables
+    public:
+        static uint8_t const FRAME_KEY   = 'K';
+        static uint8_t const FRAME_DELTA = 'D';
+    protected:
+    private:
+        RGBMatrixRenderer &output;
+        FILE* file;
+        uint8_t* previous;   // Last frame written
+        uint8_t* payload;    // Encoded frame
+        uint16_t keyframeInterval;
+        uint32_t frame;
+
+    //functions
+    public:
+        RecordingRenderer(RGBMatrixRenderer&, const char*, uint16_t=250);
+        virtual ~RecordingRenderer();
+        bool isOpen();
+        virtual void msSleep(int);
+        virtual void outputMessage(char[]);
+        virtual uint16_t random_uint(uint16_t,uint16_t);
+    protected:
+        virtual void flushPixels();
+    private:
+        void writeFrame(uint8_t, const uint8_t*, uint32_t);
+        static uint8_t* putCount(uint8_t*, uint32_t);
+}; //RecordingRenderer
+
+#endif
@@ -0,0 +1,198 @@
+/**************************************************************************************************
+ * Soup List class
+ *
+ * Keeps the longest lived random Game of Life soups found by a soup search.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SoupList.h"
+#include "golife.h"
+
+#if !defined(ARDUINO)
+#include <stdio.h>
+#endif
+
+// default constructor
+SoupList::SoupList(size_t maxSoups_)
+    : numSoups(0), maxSoups(maxSoups_), sorted(false), width(0), height(0), density(15), symmetry(0)
+{
+    soups = new Soup[maxSoups > 0 ? maxSoups : 1];
+} //SoupList
+
+// default destructor
+SoupList::~SoupList()
+{
+    delete [] soups;
+} //~SoupList
+
+//Set the grid size and density the soups were run with
+void SoupList::setGrid(int width_, int height_, uint8_t density_)
+{
+    width = width_;
+    height = height_;
+    density = density_;
+}
+
+int SoupList::getWidth()
+{
+    return width;
+}
+
+int SoupList::getHeight()
+{
+    return height;
+}
+
+uint8_t SoupList::getDensity()
+{
+    return density;
+}
+
+//Set the symmetry the soups were run with, one of the GameOfLife SYMMETRY_ values
+void SoupList::setSymmetry(uint8_t symmetry_)
+{
+    symmetry = symmetry_;
+}
+
+uint8_t SoupList::getSymmetry()
+{
+    return symmetry;
+}
+
+//Add a soup if it lasted longer than the shortest lived soup in a full list. Returns true if the
+//soup was kept.
+bool SoupList::add(const Soup &soup)
+{
+    if (sorted) {
+        //Rebuild the heap
+        for (size_t i = numSoups / 2; i-- > 0; )
+            siftDown(i, numSoups);
+        sorted = false;
+    }
+
+    if (numSoups < maxSoups) {
+        //Sift up from the end of the heap
+        size_t i = numSoups++;
+        while (i > 0 && soups[(i - 1) / 2].lifetime > soup.lifetime) {
+            soups[i] = soups[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        soups[i] = soup;
+        return true;
+    }
+    if (maxSoups == 0 || soup.lifetime <= soups[0].lifetime)
+        return false;
+
+    //Replace the shortest lived soup
+    soups[0] = soup;
+    siftDown(0, numSoups);
+    return true;
+}
+
+void SoupList::siftDown(size_t i, size_t count)
+{
+    Soup soup = soups[i];
+    while (2 * i + 1 < count) {
+        size_t child = 2 * i + 1;
+        if (child + 1 < count && soups[child + 1].lifetime < soups[child].lifetime)
+            child++;
+        if (soups[child].lifetime >= soup.lifetime)
+            break;
+        soups[i] = soups[child];
+        i = child;
+    }
+    soups[i] = soup;
+}
+
+//Sort the soups longest lived first
+void SoupList::sort()
+{
+    if (sorted)
+        return;
+
+    //Heap sort, taking the shortest lived soup off the heap to the end each time
+    for (size_t n = numSoups; n > 1; n--) {
+        Soup shortest = soups[0];
+        soups[0] = soups[n - 1];
+        soups[n - 1] = shortest;
+        siftDown(0, n - 1);
+    }
+    sorted = true;
+}
+
+size_t SoupList::getCount()
+{
+    return numSoups;
+}
+
+const SoupList::Soup& SoupList::getSoup(size_t i)
+{
+    return soups[i];
+}
+
+//Load soups saved by a soup search. Returns false if the file could not be read.
+bool SoupList::load(const char* path)
+{
+#if defined(ARDUINO)
+    return false;
+#else
+    FILE* file = fopen(path, "r");
+    if (file == NULL)
+        return false;
+
+    char line[160];
+    while (fgets(line, sizeof(line), file)) {
+        int w, h, d, s;
+        unsigned long long seed;
+        unsigned long lifetime;
+        unsigned int reason;
+        int fields = sscanf(line, "# soups %dx%d density %d symmetry %d", &w, &h, &d, &s);
+        if (fields >= 3) {
+            setGrid(w, h, d);
+            //The symmetry field is optional, and a header without one means no symmetry
+            setSymmetry(fields == 4 ? s : GameOfLife::SYMMETRY_NONE);
+        }
+        else if (line[0] != '#' && sscanf(line, "%llu %lu %u", &seed, &lifetime, &reason) == 3) {
+            Soup soup = { seed, (uint32_t)lifetime, (uint8_t)reason };
+            add(soup);
+        }
+    }
+    fclose(file);
+    sort();
+    return true;
+#endif
+}
+
+//Save the soups longest lived first. The list is sorted first.
+bool SoupList::save(const char* path)
+{
+#if defined(ARDUINO)
+    return false;
+#else
+    FILE* file = fopen(path, "w");
+    if (file == NULL)
+        return false;
+
+    sort();
+    fprintf(file, "# soups %dx%d density %d symmetry %d\n", width, height, density, symmetry);
+    fprintf(file, "# seed generations reason\n");
+    for (size_t i=0; i<numSoups; i++)
+        fprintf(file, "%llu %lu %u %s\n", (unsigned long long)soups[i].seed, (unsigned long)soups[i].lifetime,
+                soups[i].reason, GameOfLife::getEndReasonName(soups[i].reason));
+    return fclose(file) == 0;
+#endif
+}
@@ -0,0 +1,81 @@
+/**************************************************************************************************
+ * Soup List class
+ *
+ * Holds the seeds of the longest lived random Game of Life soups found by a soup search, along
+ * with how many generations each lasted and why it ended. Only the longest lived soups are kept,
+ * up to the size given when the list is created, so a search can add every soup it runs. Lists
+ * are saved as text files, one soup per line, which the display programs load to replay the
+ * soups instead of showing random ones which die out quickly.
+ *
+ * Loading and saving files is not available on Arduino builds.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SOUPLIST_H
+#define SOUPLIST_H
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#elif defined(ARDUINO)
+#include "WProgram.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+class SoupList
+{
+    //variables
+    public:
+        struct Soup {
+            uint64_t seed;
+            uint32_t lifetime;  // Generations run before the soup ended
+            uint8_t reason;     // GameOfLife end reason, END_NONE if still running at the limit
+        };
+    protected:
+    private:
+        Soup* soups;            // Heap with the shortest lived soup first, unless sorted
+        size_t numSoups;
+        size_t maxSoups;
+        bool sorted;
+        int width;              // Grid the soups were run on
+        int height;
+        uint8_t density;
+        uint8_t symmetry;       // GameOfLife symmetry of the soups
+
+    //functions
+    public:
+        SoupList(size_t);
+        ~SoupList();
+        void setGrid(int, int, uint8_t);
+        int getWidth();
+        int getHeight();
+        uint8_t getDensity();
+        void setSymmetry(uint8_t);
+        uint8_t getSymmetry();
+        bool add(const Soup&);
+        void sort();
+        size_t getCount();
+        const Soup& getSoup(size_t);
+        bool load(const char*);
+        bool save(const char*);
+    protected:
+    private:
+        void siftDown(size_t, size_t);
+}; //SoupList
+
+#endif
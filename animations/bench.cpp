@@ -0,0 +1,439 @@
+/**************************************************************************************************
+ * Benchmark suite for the animation classes. Times the hot paths of each animator across a range
+ * of grid sizes, densities and fade settings, without any display, and writes the results as
+ * JSON or CSV so they can be compared between commits. It does not use the RGB matrix library,
+ * so can be built and run on any machine.
+ *
+ * Each case is run for a number of warm-up iterations, then the number of iterations needed to
+ * take at least the minimum batch time is found, and that many iterations are timed repeatedly.
+ * The minimum, median, mean and maximum time per iteration over the repetitions are reported.
+ *
+ * For example:
+ *   ./bench -s 32,64,128 -d 15 -o results.json
+ *   ./bench -b sand -f csv
+ *
+ * Written by Paul Fretwell - aka 'Footleg'
+ * 
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <getopt.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "FrameBufferRenderer.h"
+#include "Log.h"
+
+#include "golife.h"      //These are the animation classes benchmarked
+#include "sparselife.h"
+#include "crawler.h"
+#include "fallingsand.h"
+
+// Renderer with no output, drawing into a frame buffer so pixel writes cost what they would
+// with a real frame buffer display
+class BenchRenderer : public FrameBufferRenderer {
+    public:
+        BenchRenderer(int width, int height)
+            : FrameBufferRenderer(width, height)
+        {}
+
+        virtual ~BenchRenderer() {
+            logFlush();
+        }
+
+        virtual void outputMessage(char msg[]) {
+            //Messages would distort the timings
+        }
+
+        virtual void msSleep(int delay_ms) {
+            //Time spent drawing is measured, not time spent waiting
+        }
+
+        virtual uint16_t random_uint(uint16_t a, uint16_t b) {
+            return a + rand()%(b-a);
+        }
+
+    protected:
+        virtual void flushPixels() {}
+};
+
+// Runs the private phases of GameOfLife on their own (this class is a friend of GameOfLife)
+class GameOfLifeBenchmark {
+    public:
+        static void initialise(GameOfLife &gol) {
+            gol.initialiseGrid(0);
+        }
+
+        static void applyChanges(GameOfLife &gol) {
+            gol.applyChanges();
+        }
+
+        static void fadeInChanges(GameOfLife &gol) {
+            gol.fadeInChanges();
+        }
+};
+
+struct Settings {
+    int warmup;
+    int repetitions;
+    double minBatchSeconds;
+};
+
+struct Result {
+    const char* name;
+    int width;
+    int height;
+    int density;
+    int fadeSteps;
+    uint32_t iterations;
+    double minNs;
+    double medianNs;
+    double meanNs;
+    double maxNs;
+};
+
+typedef std::chrono::steady_clock benchClock;
+
+// Time a case, where run(n) runs n iterations of it
+template<typename F>
+static Result timeCase(const Settings &settings, F run)
+{
+    Result result = {};
+    run(settings.warmup);
+
+    //Double the iterations until a batch takes long enough to time accurately
+    uint32_t iterations = 1;
+    while (true) {
+        benchClock::time_point start = benchClock::now();
+        run(iterations);
+        double secs = std::chrono::duration<double>(benchClock::now() - start).count();
+        if (secs >= settings.minBatchSeconds || iterations >= (1u << 30))
+            break;
+        iterations *= 2;
+    }
+
+    std::vector<double> times;
+    for (int r=0; r<settings.repetitions; r++) {
+        benchClock::time_point start = benchClock::now();
+        run(iterations);
+        double ns = std::chrono::duration<double, std::nano>(benchClock::now() - start).count();
+        times.push_back(ns / iterations);
+    }
+    std::sort(times.begin(), times.end());
+
+    result.iterations = iterations;
+    result.minNs = times.front();
+    result.maxNs = times.back();
+    result.medianNs = (times[(times.size() - 1) / 2] + times[times.size() / 2]) / 2;
+    double total = 0;
+    for (size_t i=0; i<times.size(); i++)
+        total += times[i];
+    result.meanNs = total / times.size();
+    return result;
+}
+
+static std::vector<int> parseList(const char* text)
+{
+    std::vector<int> values;
+    const char* p = text;
+    while (*p) {
+        values.push_back(atoi(p));
+        p = strchr(p, ',');
+        if (!p)
+            break;
+        p++;
+    }
+    return values;
+}
+
+static void writeResult(FILE* out, bool json, bool first, const Result &r)
+{
+    if (json) {
+        fprintf(out, "%s\n    {\"name\": \"%s\", \"width\": %d, \"height\": %d, \"density\": %d, \"fade_steps\": %d, "
+                "\"iterations\": %u, \"min_ns\": %.1f, \"median_ns\": %.1f, \"mean_ns\": %.1f, \"max_ns\": %.1f}",
+                first ? "" : ",", r.name, r.width, r.height, r.density, r.fadeSteps,
+                r.iterations, r.minNs, r.medianNs, r.meanNs, r.maxNs);
+    }
+    else {
+        fprintf(out, "%s,%d,%d,%d,%d,%u,%.1f,%.1f,%.1f,%.1f\n", r.name, r.width, r.height, r.density, r.fadeSteps,
+                r.iterations, r.minNs, r.medianNs, r.meanNs, r.maxNs);
+    }
+    fflush(out);
+}
+
+static int usage(const char *progname) {
+    fprintf(stderr, "usage: %s <options> [optional parameter]\n",
+            progname);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr,
+            "\t-s <list>      : Grid sizes (square), default 16,32,64,128,256,512.\n"
+            "\t-d <list>      : Densities, as percent of cells alive or filled with sand, default 5,15,30.\n"
+            "\t-F <list>      : Fade steps for fade benchmark, default 2,10,50.\n"
+            "\t-b <text>      : Only run benchmarks with names containing text.\n"
+            "\t-w <number>    : Warm-up iterations, default 10.\n"
+            "\t-r <number>    : Timed repetitions, default 5.\n"
+            "\t-m <msecs>     : Minimum time for each repetition, default 20.\n"
+            "\t-f <format>    : Output format json or csv, default json.\n"
+            "\t-o <file>      : Write results to file instead of stdout.\n"
+            "\t--seed <n>     : Random number seed, default 1.\n");
+
+    fprintf(stderr, "Benchmarks: gol.runCycle gol.advance gol.jump gol.randomise gol.applyChanges gol.fadeInChanges sparse.advance sand.runCycle crawler.runCycle\n"
+            "Example:\n\t%s -s 32,64 -b gol -f csv\n", progname);
+    return 1;
+}
+
+
+int main(int argc, char *argv[]) {
+    std::vector<int> sizes = parseList("16,32,64,128,256,512");
+    std::vector<int> densities = parseList("5,15,30");
+    std::vector<int> fades = parseList("2,10,50");
+    const char* filter = "";
+    const char* path = NULL;
+    bool json = true;
+    unsigned int seed = 1;
+    Settings settings = { 10, 5, 0.02 };
+
+    static struct option longOptions[] = {
+        { "seed", required_argument, NULL, 'S' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "s:d:F:b:w:r:m:f:o:", longOptions, NULL)) != -1) {
+        switch (opt) {
+        case 's':
+        sizes = parseList(optarg);
+        break;
+
+        case 'd':
+        densities = parseList(optarg);
+        break;
+
+        case 'F':
+        fades = parseList(optarg);
+        break;
+
+        case 'b':
+        filter = optarg;
+        break;
+
+        case 'w':
+        settings.warmup = atoi(optarg);
+        break;
+
+        case 'r':
+        settings.repetitions = atoi(optarg);
+        break;
+
+        case 'm':
+        settings.minBatchSeconds = atoi(optarg) / 1000.0;
+        break;
+
+        case 'f':
+        json = (strcmp(optarg, "csv") != 0);
+        break;
+
+        case 'o':
+        path = optarg;
+        break;
+
+        case 'S':
+        seed = strtoul(optarg, NULL, 0);
+        break;
+
+        default: /* '?' */
+        return usage(argv[0]);
+        }
+    }
+
+    if (settings.repetitions < 1)
+        settings.repetitions = 1;
+
+    FILE* out = stdout;
+    if (path) {
+        out = fopen(path, "w");
+        if (out == NULL) {
+            fprintf(stderr, "Unable to open %s\n", path);
+            return 1;
+        }
+    }
+
+    if (json)
+        fprintf(out, "{\n  \"seed\": %u, \"warmup\": %d, \"repetitions\": %d,\n  \"results\": [", seed,
+                settings.warmup, settings.repetitions);
+    else
+        fprintf(out, "name,width,height,density,fade_steps,iterations,min_ns,median_ns,mean_ns,max_ns\n");
+
+    bool first = true;
+    for (size_t s=0; s<sizes.size(); s++) {
+        int size = sizes[s];
+        if (size < 1)
+            continue;
+
+        for (size_t d=0; d<densities.size(); d++) {
+            int density = densities[d];
+
+            if (strstr("gol.runCycle", filter)) {
+                srand(seed);
+                BenchRenderer renderer(size, size);
+                GameOfLife gol(renderer, 1, 0);
+                gol.setDensity(density);
+                GameOfLifeBenchmark::initialise(gol);
+                Result r = timeCase(settings, [&](uint32_t n) {
+                    for (uint32_t i=0; i<n; i++) gol.runCycle();
+                });
+                r.name = "gol.runCycle"; r.width = size; r.height = size; r.density = density; r.fadeSteps = 1;
+                writeResult(out, json, first, r);
+                first = false;
+            }
+
+            if (strstr("gol.advance", filter)) {
+                //Times generations run without drawing, starting a new pattern when one finishes
+                srand(seed);
+                BenchRenderer renderer(size, size);
+                GameOfLife gol(renderer, 1, 0);
+                gol.setDensity(density);
+                GameOfLifeBenchmark::initialise(gol);
+                Result r = timeCase(settings, [&](uint32_t n) {
+                    for (uint32_t done=0; done<n; ) {
+                        done += gol.advance(n - done);
+                        if (done < n) GameOfLifeBenchmark::initialise(gol);
+                    }
+                });
+                r.name = "gol.advance"; r.width = size; r.height = size; r.density = density; r.fadeSteps = 1;
+                writeResult(out, json, first, r);
+                first = false;
+            }
+
+            if (strstr("gol.jump", filter)) {
+                //Times generations run a tile at a time, without checking for the end of the run
+                srand(seed);
+                BenchRenderer renderer(size, size);
+                GameOfLife gol(renderer, 1, 0);
+                gol.setDensity(density);
+                GameOfLifeBenchmark::initialise(gol);
+                Result r = timeCase(settings, [&](uint32_t n) {
+                    gol.jump(n);
+                });
+                r.name = "gol.jump"; r.width = size; r.height = size; r.density = density; r.fadeSteps = 1;
+                writeResult(out, json, first, r);
+                first = false;
+            }
+
+            if (strstr("gol.randomise", filter)) {
+                //Times filling the grid with a new random soup and drawing it
+                srand(seed);
+                BenchRenderer renderer(size, size);
+                GameOfLife gol(renderer, 1, 0);
+                gol.setDensity(density);
+                uint64_t soup = seed;
+                Result r = timeCase(settings, [&](uint32_t n) {
+                    for (uint32_t i=0; i<n; i++) gol.randomise(soup++);
+                });
+                r.name = "gol.randomise"; r.width = size; r.height = size; r.density = density; r.fadeSteps = 1;
+                writeResult(out, json, first, r);
+                first = false;
+            }
+
+            if (strstr("gol.applyChanges", filter)) {
+                //Times applying the change set from one generation of a random pattern
+                srand(seed);
+                BenchRenderer renderer(size, size);
+                GameOfLife gol(renderer, 1, 0);
+                gol.setDensity(density);
+                GameOfLifeBenchmark::initialise(gol);
+                gol.runCycle();
+                Result r = timeCase(settings, [&](uint32_t n) {
+                    for (uint32_t i=0; i<n; i++) GameOfLifeBenchmark::applyChanges(gol);
+                });
+                r.name = "gol.applyChanges"; r.width = size; r.height = size; r.density = density; r.fadeSteps = 1;
+                writeResult(out, json, first, r);
+                first = false;
+            }
+
+            for (size_t f=0; f<fades.size(); f++) {
+                if (strstr("gol.fadeInChanges", filter) && fades[f] > 1) {
+                    srand(seed);
+                    BenchRenderer renderer(size, size);
+                    GameOfLife gol(renderer, fades[f], 0);
+                    gol.setDensity(density);
+                    GameOfLifeBenchmark::initialise(gol);
+                    gol.runCycle();
+                    Result r = timeCase(settings, [&](uint32_t n) {
+                        for (uint32_t i=0; i<n; i++) GameOfLifeBenchmark::fadeInChanges(gol);
+                    });
+                    r.name = "gol.fadeInChanges"; r.width = size; r.height = size; r.density = density; r.fadeSteps = fades[f];
+                    writeResult(out, json, first, r);
+                    first = false;
+                }
+            }
+
+            if (strstr("sparse.advance", filter)) {
+                //Same soups as gol.advance, but on an unbounded plane viewed through the grid
+                srand(seed);
+                BenchRenderer renderer(size, size);
+                SparseLife life(renderer);
+                life.setDensity(density);
+                life.randomise(seed);
+                Result r = timeCase(settings, [&](uint32_t n) {
+                    for (uint32_t done=0; done<n; ) {
+                        done += life.advance(n - done);
+                        if (done < n) life.randomise(renderer.random_uint(0, 65535));
+                    }
+                });
+                r.name = "sparse.advance"; r.width = size; r.height = size; r.density = density; r.fadeSteps = 1;
+                writeResult(out, json, first, r);
+                first = false;
+            }
+
+            if (strstr("sand.runCycle", filter)) {
+                srand(seed);
+                BenchRenderer renderer(size, size);
+                int grains = size * size * density / 100;
+                FallingSand sand(renderer, 0, grains);
+                sand.setAcceleration(0, -20);
+                for (int i=0; i<grains; i++)
+                    sand.addGrain(renderer.random_uint(1, 216));
+                Result r = timeCase(settings, [&](uint32_t n) {
+                    for (uint32_t i=0; i<n; i++) sand.runCycle();
+                });
+                r.name = "sand.runCycle"; r.width = size; r.height = size; r.density = density; r.fadeSteps = 0;
+                writeResult(out, json, first, r);
+                first = false;
+            }
+        }
+
+        //Crawler cost doesn't depend on density
+        if (strstr("crawler.runCycle", filter)) {
+            srand(seed);
+            BenchRenderer renderer(size, size);
+            Crawler crawler(renderer);
+            Result r = timeCase(settings, [&](uint32_t n) {
+                for (uint32_t i=0; i<n; i++) crawler.runCycle();
+            });
+            r.name = "crawler.runCycle"; r.width = size; r.height = size; r.density = 0; r.fadeSteps = 0;
+            writeResult(out, json, first, r);
+            first = false;
+        }
+    }
+
+    if (json)
+        fprintf(out, "\n  ]\n}\n");
+    if (path)
+        fclose(out);
+    return 0;
+}
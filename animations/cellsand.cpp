@@ -0,0 +1,411 @@
+/**************************************************************************************************
+ * This is an example to demonstrate using the cellular sand animation class with the RGB matrix library
+ * from https://github.com/hzeller/rpi-rgb-led-matrix
+ *
+ * Based on the public domain demo example file by Henner Zeller, and extended by
+ * Paul Fretwell - aka 'Footleg' to use the animation classes written by Footleg with the RGBMatrix
+ * library.
+ * 
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <unistd.h>
+#include <getopt.h>
+#include <time.h>
+#include <errno.h>
+#include <signal.h>
+
+#include "led-matrix.h"
+#include "threaded-canvas-manipulator.h"
+#include "pixel-mapper.h"
+#include "graphics.h"
+
+#include "cellularsand.h" //This is the animation class used to generate output for the display
+#include "Log.h"
+
+using namespace rgb_matrix;
+
+uint8_t backbuffer = 0;      // Index for double-buffered animation
+
+volatile bool interrupt_received = false;
+static void InterruptHandler(int signo) {
+    interrupt_received = true;
+}
+
+// Monotonic clock time in nanoseconds
+static int64_t nanos()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Sleep until an absolute monotonic clock time in nanoseconds
+static void sleepUntil(int64_t deadline)
+{
+    timespec ts;
+    ts.tv_sec = deadline / 1000000000;
+    ts.tv_nsec = deadline % 1000000000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR && !interrupt_received);
+}
+
+// RGB Matrix class which pass itself as a renderer implementation into the GOL class
+// Passing as a reference into gol class, so need to dereference 'this' which is a pointer
+// using the syntax *this
+class Animation : public ThreadedCanvasManipulator, public RGBMatrixRenderer {
+    public:
+        Animation(Canvas *m, int width, int height, int delay_ms, int sub_steps, int accel_, int threads, int numGrains, int numWater)
+            : ThreadedCanvasManipulator(m), RGBMatrixRenderer{width,height}, delay_ms_(delay_ms), sub_steps_(sub_steps),
+              animation(*this), ax(0), ay(0)
+        {
+            animation.setThreads(threads);
+
+            if (delay_ms_ < 1) delay_ms_ = 1;
+            if (sub_steps_ < 1) sub_steps_ = 1;
+
+            accel = accel_;
+            angle=-1;
+            //Change gravity direction every 2.5 seconds of simulated time
+            cycles = 2500 * sub_steps_ / delay_ms_;
+            counter = cycles; //Set first direction on first step
+
+            //Create some static pixels
+
+
+            int id = 180;
+            for (int x=0; x<10;x++) {
+                animation.setStaticPixel(x+11,11,id);
+                animation.setStaticPixel(x+11,20,id);
+            }
+            for (int y=0; y<10;y++) {
+                animation.setStaticPixel(11,y+11,id);
+                animation.setStaticPixel(20,y+11,id);
+            }
+            animation.setStaticPixel(15,11,0);
+            animation.setStaticPixel(16,11,0);
+            animation.setStaticPixel(15,20,0);
+            animation.setStaticPixel(16,20,0);
+
+            //Add grains and water
+            for (int i=0; i<numGrains;i++) {
+                animation.addGrain(1 + rand()%215);
+            }
+            for (int i=0; i<numWater;i++) {
+                animation.addWater(4 + rand()%2);
+            }
+        }
+        
+        virtual ~Animation(){
+            logFlush();
+        }
+
+        void Run() {
+            // Physics runs on a fixed timestep of sub_steps_ steps per frame period, so the
+            // simulation speed does not depend on how long the grains take to draw. Frames are
+            // presented on absolute deadlines, sleeping for the remainder of each frame period.
+            const int64_t framePeriod = (int64_t)delay_ms_ * 1000000;
+            const int64_t stepPeriod = framePeriod / sub_steps_;
+            const int maxStepsPerFrame = sub_steps_ * 4; // Limit catch up when running slow
+            const int64_t reportPeriod = 5000000000LL;
+
+            int64_t now = nanos();
+            int64_t nextStep = now;
+            int64_t nextFrame = now;
+            int64_t nextReport = now + reportPeriod;
+            uint32_t steps = 0;
+            uint32_t frames = 0;
+
+            while (running() && !interrupt_received) {
+                //Run all physics steps which are due, up to the catch up limit
+                int stepsRun = 0;
+                while (nextStep <= now && stepsRun < maxStepsPerFrame) {
+                    stepPhysics();
+                    nextStep += stepPeriod;
+                    stepsRun++;
+                }
+                if (nextStep <= now) {
+                    //Too far behind to catch up, so drop the backlog rather than stall
+                    nextStep = now + stepPeriod;
+                }
+                steps += stepsRun;
+
+                animation.drawPixels();
+                frames++;
+
+                now = nanos();
+                if (now >= nextReport) {
+                    double secs = (now - nextReport + reportPeriod) / 1e9;
+                    fprintf(stderr, "Physics %.1f steps/s, display %.1f frames/s\n", steps / secs, frames / secs);
+                    steps = 0;
+                    frames = 0;
+                    nextReport = now + reportPeriod;
+                }
+
+                nextFrame += framePeriod;
+                if (nextFrame < now)
+                    nextFrame = now; //Frame overran, so present the next one as soon as possible
+                else
+                    sleepUntil(nextFrame);
+                now = nanos();
+            }
+        }
+
+        virtual void setPixel(int x, int y, uint8_t r, uint8_t g, uint8_t b) 
+        {
+            canvas()->SetPixel(x, gridHeight - y - 1, r, g, b);
+        }
+
+        virtual void showPixels() {
+            //Nothing to do for RGB matrix type displays as pixel changes are shown immediately
+        }
+
+        virtual void outputMessage(char msg[]) {
+            fprintf(stderr,msg);
+        }
+        
+        virtual void msSleep(int delay_ms) {
+            usleep(delay_ms * 1000);
+        }
+
+        virtual uint16_t random_uint(uint16_t a, uint16_t b) {
+            return a + rand()%(b-a);
+        }
+
+    private:
+        //Single physics step, changing gravity direction every 'cycles' steps
+        void stepPhysics() {
+            counter++;
+            if (counter > cycles) {
+                counter = 0;
+                angle++;
+                fprintf(stderr,"Angle %d, Accel: %d,%d\n", angle, ax, ay );
+                switch(angle) {
+                    case 0:
+                        ax = accel;
+                        ay = 0;
+                        break;
+                    case 1:
+                        ax = 0;
+                        ay = -accel;
+                        break;
+                    case 2:
+                        ax = -accel;
+                        ay = 0;
+                        break;
+                    case 3:
+                        ax = 0;
+                        ay = accel;
+                        break;
+                    case 4:
+                        ax = accel;
+                        ay = -accel;
+                        break;
+                    case 5:
+                        ax = -accel;
+                        ay = accel;
+                        angle = -1;
+                        break;
+                }
+                animation.setAcceleration(ax,ay);
+            }
+            animation.stepPhysics();
+        }
+
+        int delay_ms_;
+        int sub_steps_;
+        CellularSand animation;
+        int16_t ax,ay, accel, angle;
+        uint32_t counter, cycles;
+};
+
+
+static int usage(const char *progname) {
+    fprintf(stderr, "usage: %s <options> [optional parameter]\n",
+            progname);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr,
+            "\t-m <msecs>     : Milliseconds per displayed frame.\n"
+            "\t-u <steps>     : Physics steps per displayed frame.\n"
+            "\t-t <seconds>   : Run for these number of seconds, then exit.\n"
+            "\t-n <number>    : Number of cells of sand.\n"
+            "\t-w <number>    : Number of cells of water.\n"
+            "\t-g <number>    : Gravity force (only the direction is used).\n"
+            "\t-j <number>    : Number of threads updating the grid.\n"
+            "\t--seed <n>     : Random number seed, to repeat a run.\n");
+
+    rgb_matrix::PrintMatrixFlags(stderr);
+
+    fprintf(stderr, "Example:\n\t%s -n 300 -w 200 -g 10 -t 10 \n"
+            "Runs demo for 10 seconds\n", progname);
+    return 1;
+}
+
+
+int main(int argc, char *argv[]) {
+    int runtime_seconds = -1;
+    int scroll_ms = 10;
+    int sub_steps = 10;
+    int accel = 10;
+    int threads = 1;
+    int numGrains = 300;
+    int numWater = 200;
+
+    unsigned int seed = time(NULL);
+ 
+    RGBMatrix::Options matrix_options;
+    rgb_matrix::RuntimeOptions runtime_opt;
+
+    // These are the defaults when no command-line flags are given.
+    matrix_options.rows = 32;
+    matrix_options.chain_length = 1;
+    matrix_options.parallel = 1;
+
+    // First things first: extract the command line flags that contain
+    // relevant matrix options.
+    if (!ParseOptionsFromFlags(&argc, &argv, &matrix_options, &runtime_opt)) {
+        return usage(argv[0]);
+    }
+
+    static struct option longOptions[] = {
+        { "seed", required_argument, NULL, 'S' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "dD:t:r:P:g:j:w:c:n:p:b:m:u:LR:", longOptions, NULL)) != -1) {
+        switch (opt) {
+        case 't':
+        runtime_seconds = atoi(optarg);
+        break;
+
+        case 'm':
+        scroll_ms = atoi(optarg);
+        break;
+
+        case 'u':
+        sub_steps = atoi(optarg);
+        break;
+
+        case 'n':
+        numGrains = atoi(optarg);
+        break;
+
+        case 'g':
+        accel = atoi(optarg);
+        break;
+
+        case 'j':
+        threads = atoi(optarg);
+        break;
+
+        case 'w':
+        numWater = atoi(optarg);
+        break;
+
+        // These used to be options we understood, but deprecated now. Accept
+        // but don't mention in usage()
+        case 'R':
+        fprintf(stderr, "-R is deprecated. "
+                "Use --led-pixel-mapper=\"Rotate:%s\" instead.\n", optarg);
+        return 1;
+        break;
+
+        case 'L':
+        fprintf(stderr, "-L is deprecated. Use\n\t--led-pixel-mapper=\"U-mapper\" --led-chain=4\ninstead.\n");
+        return 1;
+        break;
+
+        case 'd':
+        runtime_opt.daemon = 1;
+        break;
+
+        case 'r':
+        fprintf(stderr, "Instead of deprecated -r, use --led-rows=%s instead.\n",
+                optarg);
+        matrix_options.rows = atoi(optarg);
+        break;
+
+        case 'P':
+        matrix_options.parallel = atoi(optarg);
+        break;
+
+        case 'c':
+        fprintf(stderr, "Instead of deprecated -c, use --led-chain=%s instead.\n",
+                optarg);
+        matrix_options.chain_length = atoi(optarg);
+        break;
+
+        case 'p':
+        matrix_options.pwm_bits = atoi(optarg);
+        break;
+
+        case 'b':
+        matrix_options.brightness = atoi(optarg);
+        break;
+
+        case 'S':
+        seed = strtoul(optarg, NULL, 0);
+        break;
+
+        default: /* '?' */
+        return usage(argv[0]);
+        }
+    }
+
+    srand(seed);
+
+    RGBMatrix *matrix = CreateMatrixFromOptions(matrix_options, runtime_opt);
+    if (matrix == NULL)
+        return 1;
+
+    printf("Size: %dx%d. Hardware gpio mapping: %s\n",
+            matrix->width(), matrix->height(), matrix_options.hardware_mapping);
+
+    Canvas *canvas = matrix;
+
+    // The ThreadedCanvasManipulator objects are filling
+    // the matrix continuously.
+    ThreadedCanvasManipulator *image_gen = NULL;
+    image_gen = new Animation(canvas, canvas->width(), canvas->height(), scroll_ms, sub_steps, accel, threads, numGrains, numWater);
+
+    // Set up an interrupt handler to be able to stop animations while they go
+    // on. Note, each demo tests for while (running() && !interrupt_received) {},
+    // so they exit as soon as they get a signal.
+    signal(SIGTERM, InterruptHandler);
+    signal(SIGINT, InterruptHandler);
+
+    // Image generating demo is crated. Now start the thread.
+    image_gen->Start();
+
+    // Now, the image generation runs in the background. We can do arbitrary
+    // things here in parallel. In this demo, we're essentially just
+    // waiting for one of the conditions to exit.
+    if (runtime_seconds > 0) {
+        sleep(runtime_seconds);
+    } else {
+        // The
+        printf("Press <CTRL-C> to exit and reset LEDs\n");
+        while (!interrupt_received) {
+        sleep(1); // Time doesn't really matter. The syscall will be interrupted.
+        }
+    }
+
+    // Stop image generating thread. The delete triggers
+    delete image_gen;
+    delete canvas;
+
+    printf("\%s. Exiting.\n",
+            interrupt_received ? "Received CTRL-C" : "Timeout reached");
+    return 0;
+}
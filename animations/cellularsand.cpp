@@ -0,0 +1,390 @@
+/**************************************************************************************************
+ * Cellular Falling Sand simulation
+ *
+ * A grid based falling sand engine, where every pixel holds a material (sand, water, wall or
+ * empty). Unlike the particle based FallingSand class, the cost of each cycle depends on the grid
+ * size rather than the number of grains, so completely filled panels still run quickly.
+ *
+ * This implementation was written as a reusable animator class where the RGB matrix hardware
+ * rendering class is passed in, so it can be used with any RGB array display by writing an
+ * implementation of a renderer class to set pixels/LED colours on the hardware.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cellularsand.h"
+#include "Log.h"
+
+#if !defined(ARDUINO)
+#include <stdlib.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+//Worker threads started by setThreads, which wait for each pass of blocks to update
+struct CellularSand::WorkerPool {
+    std::thread* threads;
+    int count;
+    std::mutex lock;
+    std::condition_variable start;      // Signalled when a pass is ready, or the workers should stop
+    std::condition_variable finished;   // Signalled when the last worker finishes a pass
+    uint32_t passes;                    // Number of passes started
+    int firstBlock;
+    int numBlocks;
+    int running;                        // Workers still updating blocks in this pass
+    bool stopping;
+};
+#endif
+
+static int8_t sign(int v)
+{
+    return (v > 0) - (v < 0);
+}
+
+// default constructor
+CellularSand::CellularSand(RGBMatrixRenderer &renderer_, int blockWidth_)
+    : renderer(renderer_)
+{
+    width = renderer.getGridWidth();
+    height = renderer.getGridHeight();
+
+    // Allocate memory for cell arrays
+    cells = new uint8_t[width * height];
+    colour = new uint8_t[width * height];
+    for (int i=0; i<width * height; i++) {
+        cells[i] = EMPTY;
+        colour[i] = 0;
+    }
+
+    // Blocks must be at least 2 columns wide so blocks updated together can't move material
+    // into the same column of the block between them
+    blockWidth = blockWidth_;
+    if (blockWidth < 2)
+        blockWidth = 2;
+
+    numThreads = 1;
+    pool = NULL;
+    gravX = 0;
+    gravY = 0;
+    clock = 0;
+    cycle = 0;
+
+} //CellularSand
+
+// default destructor
+CellularSand::~CellularSand()
+{
+    stopWorkers();
+    delete [] cells;
+    delete [] colour;
+} //~CellularSand
+
+//Run Cycle is called once per frame of the animation
+void CellularSand::runCycle()
+{
+    drawPixels();
+    stepPhysics();
+}
+
+//Draw all cells to the renderer
+void CellularSand::drawPixels()
+{
+    for(int y=0; y<height; y++) {
+        for(int x=0; x<width; x++) {
+            int i = y*width + x;
+            if ((cells[i] & MATERIAL) != EMPTY) {
+                uint8_t colcode = colour[i];
+                uint8_t b = (colcode%6)*51;
+                uint8_t g = (int(colcode/6)%6)*51;
+                uint8_t r = (int(colcode/36)%6)*51;
+
+                renderer.setPixel(x,y,r,g,b);
+            }
+            else {
+                renderer.setPixel(x,y,0,0,0);
+            }
+        }
+    }
+}
+
+//Update every cell in the grid once
+void CellularSand::stepPhysics()
+{
+    if (gravX == 0 && gravY == 0)
+        return;
+
+    clock ^= UPDATED;
+    cycle++;
+
+    int numBlocks = (width + blockWidth - 1) / blockWidth;
+
+    //Even blocks then odd blocks. Blocks in the same pass are 2 block widths apart, so they can
+    //run in parallel without touching the same cells.
+    for (int pass=0; pass<2; pass++) {
+#if !defined(ARDUINO)
+        if (pool) {
+            //Start the workers on their share of the blocks, update the first share here, then
+            //wait for the workers to finish
+            {
+                std::lock_guard<std::mutex> guard(pool->lock);
+                pool->firstBlock = pass;
+                pool->numBlocks = numBlocks;
+                pool->running = pool->count;
+                pool->passes++;
+            }
+            pool->start.notify_all();
+            stepBlocks(pass, 2*numThreads, numBlocks);
+
+            std::unique_lock<std::mutex> guard(pool->lock);
+            while (pool->running > 0)
+                pool->finished.wait(guard);
+            continue;
+        }
+#endif
+        stepBlocks(pass, 2, numBlocks);
+    }
+}
+
+//Worker thread, updating its share of the blocks each pass until the pool is stopped
+void CellularSand::runWorker(int worker)
+{
+#if !defined(ARDUINO)
+    uint32_t passesDone = 0;
+    std::unique_lock<std::mutex> guard(pool->lock);
+    while (true) {
+        while (pool->passes == passesDone && !pool->stopping)
+            pool->start.wait(guard);
+        if (pool->stopping)
+            break;
+        passesDone = pool->passes;
+        int firstBlock = pool->firstBlock;
+        int numBlocks = pool->numBlocks;
+
+        guard.unlock();
+        stepBlocks(firstBlock + 2*worker, 2*numThreads, numBlocks);
+        guard.lock();
+        if (--pool->running == 0)
+            pool->finished.notify_one();
+    }
+#endif
+}
+
+void CellularSand::stopWorkers()
+{
+#if !defined(ARDUINO)
+    if (pool == NULL)
+        return;
+    {
+        std::lock_guard<std::mutex> guard(pool->lock);
+        pool->stopping = true;
+    }
+    pool->start.notify_all();
+    for (int t=0; t<pool->count; t++)
+        pool->threads[t].join();
+    delete [] pool->threads;
+    delete pool;
+    pool = NULL;
+#endif
+}
+
+//Update every blockStep'th block, starting from firstBlock
+void CellularSand::stepBlocks(int firstBlock, int blockStep, int numBlocks)
+{
+    for (int b=firstBlock; b<numBlocks; b+=blockStep) {
+        int x1 = (b+1) * blockWidth;
+        if (x1 > width)
+            x1 = width;
+        stepBlock(b * blockWidth, x1);
+    }
+}
+
+//Sweep one block of columns, starting from the side gravity pulls towards so material moving
+//'down' lands in cells which have already been updated
+void CellularSand::stepBlock(int x0, int x1)
+{
+    //Random numbers are generated per block so the result doesn't depend on the number of threads
+    uint32_t rand = (cycle * 2654435761u) ^ (x0 * 40503u) ^ 0x9E3779B9u;
+    if (rand == 0)
+        rand = 1;
+    bool reverse = (cycle & 1) != 0;
+
+    if (gravY != 0) {
+        int y = (gravY < 0) ? 0 : height - 1;
+        for (int n=0; n<height; n++, y-=gravY) {
+            for (int i=0; i<x1-x0; i++) {
+                updateCell(reverse ? x1-1-i : x0+i, y, rand);
+            }
+        }
+    }
+    else {
+        int x = (gravX < 0) ? x0 : x1 - 1;
+        for (int n=0; n<x1-x0; n++, x-=gravX) {
+            for (int i=0; i<height; i++) {
+                updateCell(x, reverse ? height-1-i : i, rand);
+            }
+        }
+    }
+}
+
+//Move a single cell of sand or water
+void CellularSand::updateCell(int x, int y, uint32_t &rand)
+{
+    uint8_t &cell = cells[y*width + x];
+    uint8_t material = cell & MATERIAL;
+    if (material == EMPTY || material == WALL || (cell & UPDATED) == clock)
+        return;
+
+    //Mark as updated so it is not moved again this cycle
+    cell = material | clock;
+
+    //Sand sinks through water
+    bool sink = (material == SAND);
+
+    //Try straight down first
+    if (moveCell(x, y, gravX, gravY, sink))
+        return;
+
+    //Then down diagonally, picking which side to try first at random
+    rand ^= rand << 13;
+    rand ^= rand >> 17;
+    rand ^= rand << 5;
+    int8_t ax = sign(gravX - gravY);
+    int8_t ay = sign(gravX + gravY);
+    int8_t bx = sign(gravX + gravY);
+    int8_t by = sign(gravY - gravX);
+    if (rand & 1) {
+        int8_t t;
+        t = ax; ax = bx; bx = t;
+        t = ay; ay = by; by = t;
+    }
+    if (moveCell(x, y, ax, ay, sink) || moveCell(x, y, bx, by, sink))
+        return;
+
+    //Water flows sideways when it can't move down
+    if (material == WATER) {
+        if (rand & 2) {
+            if (!moveCell(x, y, -gravY, gravX, false))
+                moveCell(x, y, gravY, -gravX, false);
+        }
+        else {
+            if (!moveCell(x, y, gravY, -gravX, false))
+                moveCell(x, y, -gravY, gravX, false);
+        }
+    }
+}
+
+//Move cell at x,y by dx,dy if the target is empty, or swap with water if sink is set
+bool CellularSand::moveCell(int x, int y, int dx, int dy, bool sink)
+{
+    int tx = x + dx;
+    int ty = y + dy;
+    if (tx < 0 || tx >= width || ty < 0 || ty >= height)
+        return false;
+
+    int from = y*width + x;
+    int to = ty*width + tx;
+    uint8_t target = cells[to] & MATERIAL;
+    if (target == EMPTY) {
+        cells[to] = cells[from];
+        colour[to] = colour[from];
+        cells[from] = EMPTY;
+        return true;
+    }
+    else if (sink && target == WATER) {
+        uint8_t c = colour[to];
+        cells[to] = cells[from];
+        colour[to] = colour[from];
+        cells[from] = WATER | clock;
+        colour[from] = c;
+        return true;
+    }
+    return false;
+}
+
+void CellularSand::setAcceleration(int16_t x, int16_t y)
+{
+    //Same axes as FallingSand. Components less than half the other are ignored, giving one of 8
+    //gravity directions.
+    int16_t ax = -x;
+    int16_t ay = y;
+    gravX = (abs(ax) * 2 >= abs(ay)) ? sign(ax) : 0;
+    gravY = (abs(ay) * 2 >= abs(ax)) ? sign(ay) : 0;
+
+    LOG_INFO(renderer, "Acceleration set: %d,%d Direction: %d,%d\n", x, y, gravX, gravY);
+}
+
+//Set number of threads used to update blocks. Ignored on Arduino builds. The extra threads are
+//started here and kept until the number of threads changes, rather than started every pass.
+void CellularSand::setThreads(int threads)
+{
+#if !defined(ARDUINO)
+    threads = (threads > 1) ? threads : 1;
+    if (threads == numThreads)
+        return;
+    stopWorkers();
+    numThreads = threads;
+    if (numThreads > 1) {
+        //The thread calling stepPhysics updates the first share of the blocks itself
+        pool = new WorkerPool();
+        pool->count = numThreads - 1;
+        pool->passes = 0;
+        pool->firstBlock = 0;
+        pool->numBlocks = 0;
+        pool->running = 0;
+        pool->stopping = false;
+        pool->threads = new std::thread[pool->count];
+        for (int t=0; t<pool->count; t++)
+            pool->threads[t] = std::thread(&CellularSand::runWorker, this, t + 1);
+    }
+#endif
+}
+
+void CellularSand::addGrain(uint8_t id)
+{
+    addMaterial(SAND, id);
+}
+
+void CellularSand::addWater(uint8_t id)
+{
+    addMaterial(WATER, id);
+}
+
+//Place material at a random empty cell. id indicates the colour (currently based on 6 values each
+//per r,g,b channel so values from 1-215 represent colours)
+void CellularSand::addMaterial(uint8_t material, uint8_t id)
+{
+    //Give up after trying as many times as there are cells, as the grid may be full
+    for (int tries=0; tries<width*height; tries++) {
+        int i = renderer.random_uint(0,height) * width + renderer.random_uint(0,width);
+        if ((cells[i] & MATERIAL) == EMPTY) {
+            cells[i] = material | clock;
+            colour[i] = id;
+            return;
+        }
+    }
+}
+
+void CellularSand::setStaticPixel(uint16_t x, uint16_t y, uint8_t id)
+{
+    int i = (int)y * width + x;
+    cells[i] = id ? WALL : EMPTY;
+    colour[i] = id;
+}
+
+uint8_t CellularSand::getMaterial(uint16_t x, uint16_t y)
+{
+    return cells[(int)y * width + x] & MATERIAL;
+}
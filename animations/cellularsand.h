@@ -0,0 +1,91 @@
+/**************************************************************************************************
+ * Cellular Falling Sand simulation
+ *
+ * A grid based falling sand engine, where every pixel holds a material (sand, water, wall or
+ * empty). Unlike the particle based FallingSand class, the cost of each cycle depends on the grid
+ * size rather than the number of grains, so completely filled panels still run quickly.
+ *
+ * The grid is updated in a single sweep starting from the side the gravity is pulling towards,
+ * alternating the sweep direction along each row every cycle so material does not drift to one
+ * side. The sweep is done in column blocks, even blocks first then odd blocks, so blocks in the
+ * same pass never touch the same cells and can be updated in parallel.
+ *
+ * This implementation was written as a reusable animator class where the RGB matrix hardware
+ * rendering class is passed in, so it can be used with any RGB array display by writing an
+ * implementation of a renderer class to set pixels/LED colours on the hardware.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#elif defined(ARDUINO)
+#include "WProgram.h"
+#else
+#include <stdio.h>
+#endif
+
+#include "RGBMatrixRenderer.h"
+#include "Animator.h"
+
+class CellularSand : public Animator
+{
+    //variables
+    public:
+        static uint8_t const EMPTY = 0;
+        static uint8_t const SAND  = 1;
+        static uint8_t const WATER = 2;
+        static uint8_t const WALL  = 3;
+    protected:
+    private:
+        static uint8_t const MATERIAL = 0x03; // Mask for material bits of a cell
+        static uint8_t const UPDATED  = 0x80; // Set to the value of clock when a cell has been updated
+        RGBMatrixRenderer &renderer;
+        int width;
+        int height;
+        uint8_t* cells;   // Material of each cell, plus updated flag
+        uint8_t* colour;  // Colour code of each cell (same 6x6x6 codes as FallingSand)
+        int8_t gravX;
+        int8_t gravY;
+        uint8_t clock;    // Toggles between 0 and UPDATED every cycle
+        uint32_t cycle;
+        int blockWidth;
+        int numThreads;
+        struct WorkerPool;
+        WorkerPool* pool;   // Threads kept for updating blocks, NULL when only one thread is used
+    //functions
+    public:
+        CellularSand(RGBMatrixRenderer&,int=8);
+        ~CellularSand();
+        void runCycle();
+        void drawPixels();
+        void stepPhysics();
+        void setAcceleration(int16_t,int16_t);
+        void setThreads(int);
+        void addGrain(uint8_t);
+        void addWater(uint8_t);
+        void setStaticPixel(uint16_t,uint16_t,uint8_t);
+        uint8_t getMaterial(uint16_t,uint16_t);
+    protected:
+    private:
+        void addMaterial(uint8_t,uint8_t);
+        void stopWorkers();
+        void runWorker(int);
+        void stepBlocks(int,int,int);
+        void stepBlock(int,int);
+        void updateCell(int,int,uint32_t&);
+        bool moveCell(int,int,int,int,bool);
+}; //CellularSand
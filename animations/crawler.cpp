@@ -31,11 +31,11 @@ Crawler::Crawler(RGBMatrixRenderer &renderer_)
     : renderer(renderer_)
 {
     //Pick random start point
-    x = rand()%renderer.getGridWidth();
-    y = rand()%renderer.getGridHeight();
+    x = renderer.random_uint(0,renderer.getGridWidth());
+    y = renderer.random_uint(0,renderer.getGridHeight());
 
     //Start random direction
-    direction = rand()%4;
+    direction = renderer.random_uint(0,4);
 
     //Initial random colour
     renderer.setRandomColour();
@@ -52,42 +52,44 @@ void Crawler::runCycle()
     //Set current position pixel
     renderer.setPixel(x, y, renderer.r, renderer.g, renderer.b);
 
-    //Clear pixels around direction of travel
-    switch(direction) {
-        case 0: //Up
-            renderer.setPixel(renderer.newPositionX(x,-1,false), y, 0, 0, 0);
-            renderer.setPixel(renderer.newPositionX(x,1,false), y, 0, 0, 0);
-            renderer.setPixel(renderer.newPositionX(x,-1), renderer.newPositionY(y,1), 0, 0, 0);
-            renderer.setPixel(renderer.newPositionX(x,1), renderer.newPositionY(y,1), 0, 0, 0);
-            renderer.setPixel(x, renderer.newPositionY(y,1), 0, 0, 0);
-            break;
-        case 1: //Right
-            renderer.setPixel(x, renderer.newPositionY(y,-1), 0, 0, 0);
-            renderer.setPixel(x, renderer.newPositionY(y,1), 0, 0, 0);
-            renderer.setPixel(renderer.newPositionX(x,1), renderer.newPositionY(y,-1), 0, 0, 0);
-            renderer.setPixel(renderer.newPositionX(x,1), renderer.newPositionY(y,1), 0, 0, 0);
-            renderer.setPixel(renderer.newPositionX(x,1), y, 0, 0, 0);
-            break;
-        case 2: //Down
-            renderer.setPixel(renderer.newPositionX(x,-1,false), y, 0, 0, 0);
-            renderer.setPixel(renderer.newPositionX(x,1,false), y, 0, 0, 0);
-            renderer.setPixel(renderer.newPositionX(x,-1), renderer.newPositionY(y,-1), 0, 0, 0);
-            renderer.setPixel(renderer.newPositionX(x,1), renderer.newPositionY(y,-1), 0, 0, 0);
-            renderer.setPixel(x, renderer.newPositionY(y,-1), 0, 0, 0);
-            break;
-        case 3: //Left
-            renderer.setPixel(x, renderer.newPositionY(y,-1), 0, 0, 0);
-            renderer.setPixel(x, renderer.newPositionY(y,1), 0, 0, 0);
-            renderer.setPixel(renderer.newPositionX(x,-1), renderer.newPositionY(y,-1), 0, 0, 0);
-            renderer.setPixel(renderer.newPositionX(x,-1), renderer.newPositionY(y,1), 0, 0, 0);
-            renderer.setPixel(renderer.newPositionX(x,-1), y, 0, 0, 0);
-            break;
+    //Clear pixels around direction of travel, unless the renderer is fading out trails
+    if (renderer.getDecay() == 0) {
+        switch(direction) {
+            case 0: //Up
+                renderer.setPixel(renderer.newPositionX(x,-1,false), y, 0, 0, 0);
+                renderer.setPixel(renderer.newPositionX(x,1,false), y, 0, 0, 0);
+                renderer.setPixel(renderer.newPositionX(x,-1), renderer.newPositionY(y,1), 0, 0, 0);
+                renderer.setPixel(renderer.newPositionX(x,1), renderer.newPositionY(y,1), 0, 0, 0);
+                renderer.setPixel(x, renderer.newPositionY(y,1), 0, 0, 0);
+                break;
+            case 1: //Right
+                renderer.setPixel(x, renderer.newPositionY(y,-1), 0, 0, 0);
+                renderer.setPixel(x, renderer.newPositionY(y,1), 0, 0, 0);
+                renderer.setPixel(renderer.newPositionX(x,1), renderer.newPositionY(y,-1), 0, 0, 0);
+                renderer.setPixel(renderer.newPositionX(x,1), renderer.newPositionY(y,1), 0, 0, 0);
+                renderer.setPixel(renderer.newPositionX(x,1), y, 0, 0, 0);
+                break;
+            case 2: //Down
+                renderer.setPixel(renderer.newPositionX(x,-1,false), y, 0, 0, 0);
+                renderer.setPixel(renderer.newPositionX(x,1,false), y, 0, 0, 0);
+                renderer.setPixel(renderer.newPositionX(x,-1), renderer.newPositionY(y,-1), 0, 0, 0);
+                renderer.setPixel(renderer.newPositionX(x,1), renderer.newPositionY(y,-1), 0, 0, 0);
+                renderer.setPixel(x, renderer.newPositionY(y,-1), 0, 0, 0);
+                break;
+            case 3: //Left
+                renderer.setPixel(x, renderer.newPositionY(y,-1), 0, 0, 0);
+                renderer.setPixel(x, renderer.newPositionY(y,1), 0, 0, 0);
+                renderer.setPixel(renderer.newPositionX(x,-1), renderer.newPositionY(y,-1), 0, 0, 0);
+                renderer.setPixel(renderer.newPositionX(x,-1), renderer.newPositionY(y,1), 0, 0, 0);
+                renderer.setPixel(renderer.newPositionX(x,-1), y, 0, 0, 0);
+                break;
+        }
     }
     
     //Update direction if more than 1 step since last change
     dirChg++;
     if (dirChg > 1) {
-        int c = rand()%8;
+        int c = renderer.random_uint(0,8);
         switch(c) {
             case 0: //Turn left
                 direction--;
@@ -23,8 +23,9 @@
  */
 
 #include "RGBMatrixRenderer.h"
+#include "Animator.h"
 
-class Crawler
+class Crawler : public Animator
 {
     //variables
     public:
@@ -0,0 +1,189 @@
+/**************************************************************************************************
+ * Crawler Swarm animator class
+ *
+ * Runs many crawlers at once, each behaving like the simple Crawler class: crawling across the
+ * grid at random and changing colour every 50 steps. The crawlers are stored as separate arrays
+ * of each property rather than as objects, so a whole swarm can be stepped in one tight loop.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "crawlerswarm.h"
+
+//Steps in x and y for each direction: up, right, down, left
+static const int8_t dirX[4] = { 0, 1, 0, -1 };
+static const int8_t dirY[4] = { 1, 0, -1, 0 };
+
+// default constructor
+CrawlerSwarm::CrawlerSwarm(FrameBufferRenderer &renderer_, uint32_t numCrawlers_)
+    : renderer(renderer_)
+{
+    numCrawlers = numCrawlers_;
+    width = renderer.getGridWidth();
+    height = renderer.getGridHeight();
+
+    x = new uint16_t[numCrawlers];
+    y = new uint16_t[numCrawlers];
+    direction = new uint8_t[numCrawlers];
+    dirChg = new uint8_t[numCrawlers];
+    colChg = new uint8_t[numCrawlers];
+    red = new uint8_t[numCrawlers];
+    green = new uint8_t[numCrawlers];
+    blue = new uint8_t[numCrawlers];
+
+    //Seed swarm random numbers from the renderer
+    randState = 0;
+    for (int i=0; i<4; i++)
+        randState = (randState << 16) | renderer.random_uint(0,65535);
+    if (randState == 0)
+        randState = 1;
+
+    //Random start points, directions and colours. Colour change counters are staggered so the
+    //whole swarm doesn't change colour on the same step.
+    for (uint32_t i=0; i<numCrawlers; i++) {
+        uint64_t bits = randomBits();
+        x[i] = (bits & 0xFFFF) % width;
+        y[i] = ((bits >> 16) & 0xFFFF) % height;
+        direction[i] = (bits >> 32) & 3;
+        colChg[i] = ((bits >> 40) & 0xFF) % 50;
+        dirChg[i] = 0;
+        randomColour(i);
+    }
+} //CrawlerSwarm
+
+// default destructor
+CrawlerSwarm::~CrawlerSwarm()
+{
+    delete [] x;
+    delete [] y;
+    delete [] direction;
+    delete [] dirChg;
+    delete [] colChg;
+    delete [] red;
+    delete [] green;
+    delete [] blue;
+} //~CrawlerSwarm
+
+//Run Cycle is called once per frame of the animation
+void CrawlerSwarm::runCycle()
+{
+    uint8_t* pixels = renderer.getPixels();
+    uint64_t turns = 0;
+    bool clearTrails = (renderer.getDecay() == 0);
+
+    for (uint32_t i=0; i<numCrawlers; i++) {
+        //Set current position pixel
+        uint8_t* p = pixels + (y[i] * width + x[i]) * 3;
+        p[0] = red[i];
+        p[1] = green[i];
+        p[2] = blue[i];
+
+        //Clear pixels around direction of travel: both sides, and the 3 pixels ahead. Not needed
+        //when the renderer fades out the trails.
+        if (clearTrails) {
+            int dx = dirX[direction[i]];
+            int dy = dirY[direction[i]];
+            int aheadX = x[i] + dx;
+            int aheadY = y[i] + dy;
+            clearPixel(x[i] - dy, y[i] - dx);
+            clearPixel(x[i] + dy, y[i] + dx);
+            clearPixel(aheadX - dy, aheadY - dx);
+            clearPixel(aheadX + dy, aheadY + dx);
+            clearPixel(aheadX, aheadY);
+        }
+
+        //Random turn values for 16 crawlers come from each 64 bit random number, 1 in 8 chance
+        //of turning each way (same as Crawler)
+        if ((i & 15) == 0)
+            turns = randomBits();
+        uint8_t c = turns & 7;
+        turns >>= 4;
+
+        //Update direction if more than 1 step since last change
+        dirChg[i]++;
+        if (dirChg[i] > 1 && c < 2) {
+            direction[i] = (direction[i] + (c == 0 ? 3 : 1)) & 3;
+            dirChg[i] = 0;
+        }
+
+        //Update position, wrapping over edges
+        int nx = x[i] + dirX[direction[i]];
+        int ny = y[i] + dirY[direction[i]];
+        if (nx < 0) nx += width;
+        else if (nx >= width) nx -= width;
+        if (ny < 0) ny += height;
+        else if (ny >= height) ny -= height;
+        x[i] = nx;
+        y[i] = ny;
+
+        //Update colour every 50 steps
+        colChg[i]++;
+        if (colChg[i] >= 50) {
+            colChg[i] = 0;
+            randomColour(i);
+        }
+    }
+}
+
+//xorshift64* random number generator
+uint64_t CrawlerSwarm::randomBits()
+{
+    randState ^= randState >> 12;
+    randState ^= randState << 25;
+    randState ^= randState >> 27;
+    return randState * 2685821657736338717ULL;
+}
+
+//Random colour for one crawler, rejecting colours which are too dim (as setRandomColour)
+void CrawlerSwarm::randomColour(uint32_t i)
+{
+    uint64_t bits = randomBits();
+    int maxBrightness = renderer.getMaxBrightness();
+    int r = ((bits & 0xFFFF) * (maxBrightness + 1)) >> 16;
+    int g = (((bits >> 16) & 0xFFFF) * (maxBrightness + 1)) >> 16;
+    int b = (((bits >> 32) & 0xFFFF) * (maxBrightness + 1)) >> 16;
+    int minBrightness = maxBrightness * 3 / 4;
+
+    if (r<minBrightness && g<minBrightness && b<minBrightness) {
+        switch ((bits >> 48) % 3) {
+        case 0:
+            r = 200;
+            break;
+        case 1:
+            g = 200;
+            break;
+        case 2:
+            b = 200;
+            break;
+        }
+    }
+    red[i] = r;
+    green[i] = g;
+    blue[i] = b;
+}
+
+//Clear a pixel, wrapping coordinates over the grid edges
+void CrawlerSwarm::clearPixel(int px, int py)
+{
+    if (px < 0) px += width;
+    else if (px >= width) px -= width;
+    if (py < 0) py += height;
+    else if (py >= height) py -= height;
+    uint8_t* p = renderer.getPixels() + (py * width + px) * 3;
+    p[0] = 0;
+    p[1] = 0;
+    p[2] = 0;
+}
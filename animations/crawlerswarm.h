@@ -0,0 +1,64 @@
+/**************************************************************************************************
+ * Crawler Swarm animator class
+ *
+ * Runs many crawlers at once, each behaving like the simple Crawler class: crawling across the
+ * grid at random and changing colour every 50 steps. The crawlers are stored as separate arrays
+ * of each property rather than as objects, so a whole swarm can be stepped in one tight loop.
+ * Random turns for 16 crawlers are taken from each 64 bit random number, and pixels are written
+ * straight into the frame buffer of the renderer, so thousands of crawlers can run at full frame
+ * rate. Each crawler has its own colour.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRAWLERSWARM_H
+#define CRAWLERSWARM_H
+
+#include "FrameBufferRenderer.h"
+#include "Animator.h"
+
+class CrawlerSwarm : public Animator
+{
+    //variables
+    public:
+    protected:
+    private:
+        FrameBufferRenderer &renderer;
+        uint32_t numCrawlers;
+        int width;
+        int height;
+        uint16_t* x;
+        uint16_t* y;
+        uint8_t* direction;
+        uint8_t* dirChg;
+        uint8_t* colChg;
+        uint8_t* red;
+        uint8_t* green;
+        uint8_t* blue;
+        uint64_t randState;
+    //functions
+    public:
+        CrawlerSwarm(FrameBufferRenderer&,uint32_t);
+        ~CrawlerSwarm();
+        void runCycle();
+    protected:
+    private:
+        uint64_t randomBits();
+        void randomColour(uint32_t);
+        void clearPixel(int,int);
+}; //CrawlerSwarm
+
+#endif
@@ -23,78 +23,155 @@
  * You should have received a copy of the GNU General Public License
  * along with this software.  If not, see <http://www.gnu.org/licenses/>.
  */#include "fallingsand.h"
+#include "Log.h"
 
 #include <iostream>
 #include <cmath>
 
+//Phases timed when built with FRAME_TIMING
+enum { PHASE_DRAW, PHASE_SORT, PHASE_ACCEL, PHASE_MOVE, NUM_PHASES };
+static const char* const timingPhases[NUM_PHASES] = { "draw", "sort", "accel", "move" };
+
+static const sand_index_t tileSize = 1 << SAND_TILE_BITS;
+static const sand_index_t tileMask = tileSize - 1;
+
+//Spread the low 4 bits of v out to the even bits, for interleaving x and y into Morton order
+static inline sand_index_t spreadBits(sand_index_t v)
+{
+    v = (v | (v << 2)) & 0x33;
+    v = (v | (v << 1)) & 0x55;
+    return v;
+}
+
+//Packed 1 bit per pixel map helpers
+static inline bool testBit(const uint8_t* bits, sand_index_t idx)
+{
+    return (bits[idx >> 3] >> (idx & 7)) & 1;
+}
+
+static inline void setBit(uint8_t* bits, sand_index_t idx)
+{
+    bits[idx >> 3] |= (1 << (idx & 7));
+}
+
+static inline void clearBit(uint8_t* bits, sand_index_t idx)
+{
+    bits[idx >> 3] &= ~(1 << (idx & 7));
+}
+
         
 // default constructor
-FallingSand::FallingSand(RGBMatrixRenderer &renderer_, int16_t shake_, uint16_t num_grains)
+FallingSand::FallingSand(RGBMatrixRenderer &renderer_, int16_t shake_, sand_index_t num_grains)
     : renderer(renderer_)
 {
-    // Allocate memory for pixels array
-    img = new uint8_t[renderer.getGridWidth() * renderer.getGridHeight()];
+    // Allocate memory for pixel maps, rounded up to whole tiles
+    tilesPerRow = (renderer.getGridWidth() + tileMask) >> SAND_TILE_BITS;
+    sand_index_t tileRows = (renderer.getGridHeight() + tileMask) >> SAND_TILE_BITS;
+    numPixels = tilesPerRow * tileRows * tileSize * tileSize;
+    staticBits = new uint8_t[(numPixels + 7) / 8];
+    occupiedBits = new uint8_t[(numPixels + 7) / 8];
+    grainMap = new sand_index_t[numPixels];
 
-    // Allocate memory for grains array
+    // Allocate memory for grains arrays. Sorting arrays are allocated when sorting is enabled.
     grain = new Grain[num_grains];
+    grainColour = new uint8_t[num_grains];
+    sortedGrain = NULL;
+    sortedColour = NULL;
 
-    // The 'sand' grains exist in an integer coordinate space that's 256X
-    // the scale of the pixel grid, allowing them to move and interact at
+    // The 'sand' grains exist in an integer coordinate space that's subPixel (256 by default)
+    // times the scale of the pixel grid, allowing them to move and interact at
     // less than whole-pixel increments.
-    maxX = renderer.getGridWidth()  * 256 - 1; // Maximum X coordinate in grain space
-    maxY = renderer.getGridHeight() * 256 - 1; // Maximum Y coordinate in grain space
+    maxX = renderer.getGridWidth()  * subPixel - 1; // Maximum X coordinate in grain space
+    maxY = renderer.getGridHeight() * subPixel - 1; // Maximum Y coordinate in grain space
 
-    velCap = 256;
+    velCap = subPixel;
     grainsAdded = 0;
     numGrains = num_grains;
     shake = shake_;
+    sortInterval = 0;
+    sortCounter = 0;
 
     //Initial random colour
     renderer.setRandomColour();
 
-    //Clear img
-    for (uint16_t i=0; i<renderer.getGridWidth() * renderer.getGridHeight(); i++) {
-        img[i]=0;
+    //Clear maps
+    for (sand_index_t i=0; i<(numPixels + 7) / 8; i++) {
+        staticBits[i] = 0;
+        occupiedBits[i] = 0;
     }
 
+    TIMING_INIT(renderer, timingPhases, NUM_PHASES);
+
 } //FallingSand
 
 // default destructor
 FallingSand::~FallingSand()
 {
-    delete [] img;
+    delete [] staticBits;
+    delete [] occupiedBits;
+    delete [] grainMap;
+    delete [] grain;
+    delete [] grainColour;
+    delete [] sortedGrain;
+    delete [] sortedColour;
+    TIMING_FREE();
 } //~FallingSand
 
 //Run Cycle is called once per frame of the animation
 void FallingSand::runCycle()
+{
+    drawPixels();
+    stepPhysics();
+}
+
+//Draw all pixels to the renderer. Separate from the physics step so callers can run several
+//physics steps per displayed frame
+void FallingSand::drawPixels()
 {
     // Update pixel data on display
+    TIMING_START(PHASE_DRAW);
     for(int y=0; y<renderer.getGridHeight(); y++) {
-//        char msg[255];
-//        std::string line = "";
         for(int x=0; x<renderer.getGridWidth(); x++) {
-//            line += std::to_string((img[y*renderer.getGridWidth() + x])) + ",";
-            uint8_t colcode = img[y*renderer.getGridWidth() + x];
-            if (colcode) {
-                /**/
+            sand_index_t idx = pixelIndex(x,y);
+            if (testBit(occupiedBits, idx)) {
+                uint8_t colcode;
+                if (testBit(staticBits, idx))
+                    colcode = grainMap[idx];
+                else
+                    colcode = grainColour[grainMap[idx]];
+
                 uint8_t b = (colcode%6)*51;
                 uint8_t g = (int(colcode/6)%6)*51;
                 uint8_t r = (int(colcode/36)%6)*51;
 
                 renderer.setPixel(x,y,r,g,b);
-                
-                //renderer.setPixel(x,y,renderer.r,renderer.g,renderer.b);
-//                sprintf(msg,"Pixel at %d\n",int(y*renderer.getGridWidth() + x) );
-//                renderer.outputMessage(msg);
             }
             else {
                 renderer.setPixel(x,y,0,0,0);
             }
         }
-//        sprintf(msg,"%s\n", const_cast<char*>(line.c_str()) );
-//        renderer.outputMessage(msg);
     }
-    
+    TIMING_STOP(PHASE_DRAW);
+
+    //Each displayed frame includes the physics steps run since the last one
+    TIMING_FRAME();
+}
+
+//Advance the grain positions by one physics step, without drawing
+void FallingSand::stepPhysics()
+{
+    // Periodically put grains back in memory order of the pixel map, so the collision
+    // checks below walk through the map instead of jumping around it
+    if (sortInterval > 0) {
+        sortCounter++;
+        if (sortCounter >= sortInterval) {
+            sortCounter = 0;
+            TIMING_START(PHASE_SORT);
+            sortGrains();
+            TIMING_STOP(PHASE_SORT);
+        }
+    }
+
     // Read accelerometer...
     int16_t ax = -accelX,      // Transform accelerometer axes
             ay =  accelY,      // to grain coordinate space
@@ -106,30 +183,28 @@ void FallingSand::runCycle()
     int16_t az2 = az * 2 + 1;         // Range of random motion to add back in
 
     // ...and apply 2D accel vector to grain velocities...
+    TIMING_START(PHASE_ACCEL);
     int32_t v2; // Velocity squared
     float   v;  // Absolute velocity
-    for(int16_t i=0; i<numGrains; i++) {
+    for(sand_index_t i=0; i<grainsAdded; i++) {
         grain[i].vx += ax + renderer.random_uint(0,az2); // A little randomness makes
         grain[i].vy += ay + renderer.random_uint(0,az2); // tall stacks topple better!
-        // Terminal velocity (in any direction) is 256 units -- equal to
+        // Terminal velocity (in any direction) is subPixel units -- equal to
         // 1 pixel -- which keeps moving grains from passing through each other
         // and other such mayhem.  Though it takes some extra math, velocity is
         // clipped as a 2D vector (not separately-limited X & Y) so that
         // diagonal movement isn't faster
         v2 = (int32_t)grain[i].vx*grain[i].vx+(int32_t)grain[i].vy*grain[i].vy;
 
-        if(v2 > (velCap*velCap) ) { // If v^2 > 65536, then v > 256
+        if(v2 > (velCap*velCap) ) { // If v^2 > velCap^2, then v > velCap
             v = sqrt((float)v2); // Velocity vector magnitude
             grain[i].vx = (int16_t)(velCap*(float)grain[i].vx/v); // Maintain heading
             grain[i].vy = (int16_t)(velCap*(float)grain[i].vy/v); // Limit magnitude
         }
-if (i<0) {
-    char msg[80];
-    sprintf(msg, "Grain %d Vel: %d,%d; a=%d,%d,%d az2=%d\n", i, int(grain[i].vx), int(grain[i].vy), ax, ay, az, az2 );
-    renderer.outputMessage(msg);
-}
     }
         
+    TIMING_STOP(PHASE_ACCEL);
+
     // ...then update position of each grain, one at a time, checking for
     // collisions and having them react.  This really seems like it shouldn't
     // work, as only one grain is considered at a time while the rest are
@@ -141,12 +216,14 @@ if (i<0) {
     // calculations and volument of code quickly got out of hand for both
     // the tiny 8-bit AVR microcontroller and my tiny dinosaur brain.)
 
-    uint16_t        i, oldidx, newidx, delta;
-    int16_t        newx, newy;
-    
-    for(i=0; i<numGrains; i++) {
-        newx = grain[i].x + (grain[i].vx/32); // New position in grain space
-        newy = grain[i].y + (grain[i].vy/32);
+    sand_index_t    i, oldidx, newidx;
+    sand_index_t    oldpx, oldpy, newpx, newpy;
+    sand_coord_t    newx, newy;
+
+    TIMING_START(PHASE_MOVE);
+    for(i=0; i<grainsAdded; i++) {
+        newx = grain[i].x + (grain[i].vx/velDiv); // New position in grain space
+        newy = grain[i].y + (grain[i].vy/velDiv);
         if(newx > maxX) {               // If grain would go out of bounds
             newx         = maxX;          // keep it inside, and
             grain[i].vx /= -2;             // give a slight bounce off the wall
@@ -162,20 +239,21 @@ if (i<0) {
             grain[i].vy /= -2;
         }
 
-        oldidx = (grain[i].y/256) * renderer.getGridWidth() + (grain[i].x/256); // Prior pixel #
-        newidx = (newy      /256) * renderer.getGridWidth() + (newx      /256); // New pixel #
-//char msg[100];
-//sprintf(msg, "Grain %d: Old %d  (Calc %d)\n", i, oldidx, (grain[i].y/256) * renderer.getGridWidth() + (grain[i].x/256) );
-//renderer.outputMessage(msg);
+        oldpx  = grain[i].x/subPixel; // Prior pixel
+        oldpy  = grain[i].y/subPixel;
+        newpx  = newx/subPixel;       // New pixel
+        newpy  = newy/subPixel;
+        oldidx = pixelIndex(oldpx, oldpy); // Prior pixel #
+        newidx = pixelIndex(newpx, newpy); // New pixel #
         if((oldidx != newidx) && // If grain is moving to a new pixel...
-            img[newidx]) 
+            testBit(occupiedBits, newidx)) 
         {       // but if that pixel is already occupied...
-            delta = abs(newidx - oldidx); // What direction when blocked?
-            if(delta == 1) {            // 1 pixel left or right)
+            // What direction when blocked?
+            if(newpy == oldpy) {        // 1 pixel left or right)
                 newx         = grain[i].x;  // Cancel X motion
                 grain[i].vx /= -2;          // and bounce X velocity (Y is OK)
                 newidx       = oldidx;      // No pixel change
-            } else if(delta == renderer.getGridWidth()) { // 1 pixel up or down
+            } else if(newpx == oldpx) { // 1 pixel up or down
                 newy         = grain[i].y;  // Cancel Y motion
                 grain[i].vy /= -2;          // and bounce Y velocity (X is OK)
                 newidx       = oldidx;      // No pixel change
@@ -185,13 +263,13 @@ if (i<0) {
                 // (both-axis) motion is occurring, moving on either axis alone WILL
                 // change the pixel index, no need to check that again.
                 if((abs(grain[i].vx) - abs(grain[i].vy)) >= 0) { // X axis is faster
-                    newidx = (grain[i].y / 256) * renderer.getGridWidth() + (newx / 256);
-                    if(!img[newidx]) { // That pixel's free!  Take it!  But...
+                    newidx = pixelIndex(newpx, oldpy);
+                    if(!testBit(occupiedBits, newidx)) { // That pixel's free!  Take it!  But...
                         newy         = grain[i].y; // Cancel Y motion
                         grain[i].vy /= -2;         // and bounce Y velocity
                     } else { // X pixel is taken, so try Y...
-                        newidx = (newy / 256) * renderer.getGridWidth() + (grain[i].x / 256);
-                        if(!img[newidx]) { // Pixel is free, take it, but first...
+                        newidx = pixelIndex(oldpx, newpy);
+                        if(!testBit(occupiedBits, newidx)) { // Pixel is free, take it, but first...
                         newx         = grain[i].x; // Cancel X motion
                         grain[i].vx /= -2;         // and bounce X velocity
                         } else { // Both spots are occupied
@@ -203,13 +281,13 @@ if (i<0) {
                         }
                     }
                 } else { // Y axis is faster, start there
-                    newidx = (newy / 256) * renderer.getGridWidth() + (grain[i].x / 256);
-                    if(!img[newidx]) { // Pixel's free!  Take it!  But...
+                    newidx = pixelIndex(oldpx, newpy);
+                    if(!testBit(occupiedBits, newidx)) { // Pixel's free!  Take it!  But...
                         newx         = grain[i].x; // Cancel X motion
                         grain[i].vy /= -2;         // and bounce X velocity
                     } else { // Y pixel is taken, so try X...
-                        newidx = (grain[i].y / 256) * renderer.getGridWidth() + (newx / 256);
-                        if(!img[newidx]) { // Pixel is free, take it, but first...
+                        newidx = pixelIndex(newpx, oldpy);
+                        if(!testBit(occupiedBits, newidx)) { // Pixel is free, take it, but first...
                             newy         = grain[i].y; // Cancel Y motion
                             grain[i].vy /= -2;         // and bounce Y velocity
                         } else { // Both spots are occupied
@@ -226,13 +304,14 @@ if (i<0) {
         grain[i].x  = newx; // Update grain position
         grain[i].y  = newy;
         if (oldidx != newidx) {
-            uint8_t colcode = img[oldidx];
-            img[oldidx] = 0;       // Clear old spot
-            img[newidx] = colcode; // Set new spot
+            clearBit(occupiedBits, oldidx); // Clear old spot
+            setBit(occupiedBits, newidx);   // Set new spot
+            grainMap[newidx] = i;
         }
 //sprintf(msg, "Chang %d: %d -> %d\n", i, oldidx, newidx );
 //renderer.outputMessage(msg);
     }
+    TIMING_STOP(PHASE_MOVE);
 }
 
 void FallingSand::setAcceleration(int16_t x, int16_t y)
@@ -242,15 +321,13 @@ void FallingSand::setAcceleration(int16_t x, int16_t y)
     
     //Limit maximum velocity based on strength of gravity
     uint16_t maxVel = sqrt( (int32_t)x*x+(int32_t)y*y ) * 5;
-    const int16_t minVelCap = 256;
+    const int16_t minVelCap = subPixel;
     if (maxVel > minVelCap)
         velCap = maxVel;
     else
         velCap = minVelCap;
 
-    char msg[255];
-    sprintf(msg,"Acceleration set: %d,%d Max: %f\n", accelX, accelY, velCap );
-    renderer.outputMessage(msg);
+    LOG_INFO(renderer, "Acceleration set: %d,%d Max: %f\n", accelX, accelY, velCap);
 }
 
 void FallingSand::addGrain(uint8_t id)
@@ -258,23 +335,119 @@ void FallingSand::addGrain(uint8_t id)
     //Place grains into array.
     //id indicates grain colour (currently based on 6 values each per r,g,b channel
     //so values from 1-215 represent colours)
-    uint16_t i = grainsAdded;
+    if (grainsAdded >= numGrains)
+        return;
+
+    sand_index_t i = grainsAdded;
+    sand_index_t idx;
     do {
-        grain[i].x = renderer.random_uint(0,renderer.getGridWidth()  * 256); // Assign random position within
-        grain[i].y = renderer.random_uint(0,renderer.getGridHeight() * 256); // the 'grain' coordinate space
+        // Assign random position within the 'grain' coordinate space. Pixel and sub-pixel
+        // positions are picked separately as grain space can exceed the random_uint range.
+        grain[i].x = renderer.random_uint(0,renderer.getGridWidth())  * subPixel + renderer.random_uint(0,subPixel);
+        grain[i].y = renderer.random_uint(0,renderer.getGridHeight()) * subPixel + renderer.random_uint(0,subPixel);
         // Check if corresponding pixel position is already occupied...
-    } while(img[(grain[i].y / 256) * renderer.getGridWidth() + (grain[i].x / 256)]); // Keep retrying until a clear spot is found
+        idx = pixelIndex(grain[i].x / subPixel, grain[i].y / subPixel);
+    } while(testBit(occupiedBits, idx)); // Keep retrying until a clear spot is found
     grainsAdded++;
     grain[i].vx = grain[i].vy = 0; // Initial velocity is zero
-    img[(grain[i].y / 256) * renderer.getGridWidth() + (grain[i].x / 256)] = id; // Mark it
-
-char msg[100];
-sprintf(msg, "Grains placed %d,%d colour:%d\n", int(grain[i].x), int(grain[i].y), int(img[(grain[i].y / 256) * renderer.getGridWidth() + (grain[i].x / 256)]) );
-renderer.outputMessage(msg);
+    grainColour[i] = id;
+    setBit(occupiedBits, idx); // Mark it
+    grainMap[idx] = i;
 
+    LOG_DEBUG(renderer, "Grains placed %d,%d colour:%d\n", int(grain[i].x), int(grain[i].y), int(id));
 }
 
+//Set an obstacle pixel, with colour id, or clear it if id is 0. Pixels holding a grain are left
+//alone, so obstacles should be set up before grains are added.
 void FallingSand::setStaticPixel(uint16_t x, uint16_t y, uint8_t id)
 {
-    img[y * renderer.getGridWidth() + x] = id; // Mark it
+    sand_index_t idx = pixelIndex(x,y);
+    if (testBit(occupiedBits, idx) && !testBit(staticBits, idx))
+        return;
+
+    if (id) {
+        setBit(staticBits, idx); // Mark it
+        setBit(occupiedBits, idx);
+        grainMap[idx] = id;      // Obstacles keep their colour in the grain map
+    }
+    else {
+        clearBit(staticBits, idx);
+        clearBit(occupiedBits, idx);
+    }
+}
+
+//Remove all grains, leaving the obstacles in place
+void FallingSand::clearGrains()
+{
+    for (sand_index_t i=0; i<(numPixels + 7) / 8; i++) {
+        occupiedBits[i] = staticBits[i];
+    }
+    grainsAdded = 0;
+}
+
+bool FallingSand::isStaticPixel(uint16_t x, uint16_t y)
+{
+    return testBit(staticBits, pixelIndex(x,y));
+}
+
+//Index of the grain at a pixel, or the number of grains if there isn't one there
+sand_index_t FallingSand::getGrainAt(uint16_t x, uint16_t y)
+{
+    sand_index_t idx = pixelIndex(x,y);
+    if (!testBit(occupiedBits, idx) || testBit(staticBits, idx))
+        return numGrains;
+    return grainMap[idx];
+}
+
+//Re-sort grains into pixel map order every 'interval' physics steps (0 to disable)
+void FallingSand::setSortInterval(uint16_t interval)
+{
+    sortInterval = interval;
+    sortCounter = 0;
+    if (sortInterval > 0 && sortedGrain == NULL) {
+        sortedGrain = new Grain[numGrains];
+        sortedColour = new uint8_t[numGrains];
+    }
+}
+
+//Index of a pixel in the tiled pixel map. Tiles are stored row by row, and the pixels within
+//each tile in Morton order (x and y bits interleaved).
+inline sand_index_t FallingSand::pixelIndex(sand_index_t x, sand_index_t y)
+{
+#if SAND_TILE_BITS > 0
+    sand_index_t tile = (y >> SAND_TILE_BITS) * tilesPerRow + (x >> SAND_TILE_BITS);
+    return (tile << (2 * SAND_TILE_BITS)) | spreadBits(x & tileMask) | (spreadBits(y & tileMask) << 1);
+#else
+    return y * tilesPerRow + x;
+#endif
+}
+
+//As each pixel holds at most one grain, walking the occupied pixels in map order and looking up
+//the grain in each gives the sorted order directly, without comparing grains
+void FallingSand::sortGrains()
+{
+    sand_index_t n = 0;
+    for (sand_index_t b=0; b<(numPixels + 7) / 8; b++) {
+        uint8_t grainBits = occupiedBits[b] & ~staticBits[b];
+        while (grainBits) {
+            uint8_t bit = 0;
+            while (!((grainBits >> bit) & 1))
+                bit++;
+            grainBits &= ~(1 << bit);
+
+            sand_index_t idx = b * 8 + bit;
+            sand_index_t g = grainMap[idx];
+            sortedGrain[n] = grain[g];
+            sortedColour[n] = grainColour[g];
+            grainMap[idx] = n;
+            n++;
+        }
+    }
+
+    Grain* tmpGrain = grain;
+    grain = sortedGrain;
+    sortedGrain = tmpGrain;
+    uint8_t* tmpColour = grainColour;
+    grainColour = sortedColour;
+    sortedColour = tmpColour;
 }
\ No newline at end of file
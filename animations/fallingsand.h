@@ -35,27 +35,91 @@
 #include <tuple>
 
 #include "RGBMatrixRenderer.h"
+#include "Animator.h"
+#include "FrameTimer.h"
+
+// Width of grain indices and grain space coordinates. The compact 16 bit layout limits the grid
+// to 65535 pixels, and to 127 pixels wide or high at the default 256x sub-pixel scale. This keeps
+// memory use down on AVR/ESP builds, while other builds default to 32 bit types so large chained
+// panels can be used. Override with -DSAND_INDEX_BITS=16 or 32.
+#ifndef SAND_INDEX_BITS
+#if defined(ARDUINO)
+#define SAND_INDEX_BITS 16
+#else
+#define SAND_INDEX_BITS 32
+#endif
+#endif
+
+#if SAND_INDEX_BITS > 16
+typedef uint32_t sand_index_t; // Pixel and grain indices
+typedef int32_t  sand_coord_t; // Position in grain space
+#else
+typedef uint16_t sand_index_t;
+typedef int16_t  sand_coord_t;
+#endif
+
+// Grain space resolution per pixel as a power of 2 (8 gives 256 positions per pixel). Grain
+// velocities are 16 bit and capped at no less than one pixel per cycle, so 12 bits is the most
+// which leaves room for the acceleration added each cycle before the cap is applied.
+#ifndef SAND_SUBPIXEL_BITS
+#define SAND_SUBPIXEL_BITS 8
+#endif
+
+#if SAND_SUBPIXEL_BITS < 3
+#error "SAND_SUBPIXEL_BITS must be at least 3"
+#endif
+#if SAND_SUBPIXEL_BITS > 12
+#error "SAND_SUBPIXEL_BITS must be 12 or less"
+#endif
+
+// Pixel map tile size as a power of 2. Pixels within each square tile are stored together in
+// Z-order (Morton order), so grains which are close together on the grid are also close together
+// in memory. 0 gives a plain row by row layout, which is the default on Arduino builds.
+#ifndef SAND_TILE_BITS
+#if defined(ARDUINO)
+#define SAND_TILE_BITS 0
+#else
+#define SAND_TILE_BITS 3
+#endif
+#endif
+
+#if SAND_TILE_BITS > 4
+#error "SAND_TILE_BITS must be 4 or less"
+#endif
 
 
-class FallingSand
+class FallingSand : public Animator
 {
     //variables
     public:
     protected:
     private:
+        static const int subPixel = 1 << SAND_SUBPIXEL_BITS;
+        static const int velDiv = subPixel / 8; // Velocity units per grain space unit moved each cycle
         int delayms;
         RGBMatrixRenderer &renderer;
 
         struct Grain {
-            int16_t  x,  y; // Position
-            int16_t vx, vy; // Velocity
+            sand_coord_t x,  y; // Position
+            int16_t     vx, vy; // Velocity
         };
         Grain* grain;
-        uint16_t numGrains;
-        uint16_t grainsAdded;
+        sand_index_t numGrains;
+        sand_index_t grainsAdded;
         int maxX;
         int maxY;
-        uint8_t* img; // Internal 'map' of pixels
+        // Internal 'maps' of pixels, all in tiled layout (see pixelIndex)
+        uint8_t* staticBits;      // 1 bit per pixel, set for static obstacles
+        uint8_t* occupiedBits;    // 1 bit per pixel, set for obstacles and grains
+        sand_index_t* grainMap;   // Index of the grain in each occupied pixel (or colour of obstacle)
+        uint8_t* grainColour;     // Colour code of each grain
+        Grain* sortedGrain;       // Scratch arrays for sorting grains
+        uint8_t* sortedColour;
+        sand_index_t numPixels;
+        sand_index_t tilesPerRow;
+        uint16_t sortInterval;
+        uint16_t sortCounter;
+        FrameTimer* timer;      // Phase timer, NULL unless built with FRAME_TIMING
         int16_t accelX;
         int16_t accelY;
         int16_t accelAbs;
@@ -63,12 +127,20 @@ class FallingSand
         float velCap;
     //functions
     public:
-        FallingSand(RGBMatrixRenderer&,int16_t,uint16_t);
+        FallingSand(RGBMatrixRenderer&,int16_t,sand_index_t);
         ~FallingSand();
         void runCycle();
+        void drawPixels();
+        void stepPhysics();
         void setAcceleration(int16_t,int16_t);
         void addGrain(uint8_t);
         void setStaticPixel(uint16_t,uint16_t,uint8_t);
+        void setSortInterval(uint16_t);
+        void clearGrains();
+        bool isStaticPixel(uint16_t,uint16_t);
+        sand_index_t getGrainAt(uint16_t,uint16_t);
     protected:
     private:
+        sand_index_t pixelIndex(sand_index_t,sand_index_t);
+        void sortGrains();
 }; //FallingSand
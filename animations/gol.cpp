@@ -21,6 +21,7 @@
  */
 
 #include <unistd.h>
+#include <getopt.h>
 #include <signal.h>
 
 #include "led-matrix.h"
@@ -28,7 +29,11 @@
 #include "pixel-mapper.h"
 #include "graphics.h"
 
-#include "golife.h" //This is the animation class used to generate output for the display
+#include "golife.h" //These are the animation classes used to generate output for the display
+#include "sparselife.h"
+#include "PatternLoader.h"
+#include "SoupList.h"
+#include "Log.h"
 
 using namespace rgb_matrix;
 
@@ -42,15 +47,31 @@ static void InterruptHandler(int signo) {
 // using the syntax *this
 class Animation : public ThreadedCanvasManipulator, public RGBMatrixRenderer {
     public:
-        Animation(Canvas *m, int width, int height, int delay_ms, uint8_t fade_steps)
-            : ThreadedCanvasManipulator(m), RGBMatrixRenderer{width,height}, delay_ms_(delay_ms), animation(*this,fade_steps,delay_ms_)
-        {}
+        Animation(Canvas *m, int width, int height, int delay_ms, uint8_t fade_steps, PatternLoader* patterns,
+                  SoupList* soups, bool sparse)
+            : ThreadedCanvasManipulator(m), RGBMatrixRenderer{width,height}, delay_ms_(delay_ms)
+        {
+            if (sparse) {
+                SparseLife* life = new SparseLife(*this);
+                life->setPatterns(patterns);
+                animation = life;
+            }
+            else {
+                GameOfLife* gol = new GameOfLife(*this,fade_steps,delay_ms_);
+                gol->setPatterns(patterns);
+                gol->setSoups(soups);
+                animation = gol;
+            }
+        }
 
-        virtual ~Animation(){}
+        virtual ~Animation(){
+            logFlush();
+            delete animation;
+        }
 
         void Run() {
             while (running() && !interrupt_received) {
-                animation.runCycle();
+                animation->runCycle();
                 usleep(delay_ms_ * 1000); // ms
             }
         }
@@ -78,7 +99,7 @@ class Animation : public ThreadedCanvasManipulator, public RGBMatrixRenderer {
 
     private:
         int delay_ms_;
-        GameOfLife animation;
+        Animator* animation;
 };
 
 
@@ -89,7 +110,11 @@ static int usage(const char *progname) {
     fprintf(stderr,
             "\t-m <msecs>                : Milliseconds pause between updates.\n"
             "\t-t <seconds>              : Run for these number of seconds, then exit.\n"
-            "\t-f <steps>                : Number of steps in colour fades (1=no fades).\n");
+            "\t-f <steps>                : Number of steps in colour fades (1=no fades).\n"
+            "\t-l <file>                 : Load RLE or Life 1.06 patterns to show (can be repeated).\n"
+            "\t--soups <file>            : Replay long lived soups saved by the soups program.\n"
+            "\t--sparse                  : Show a window onto an unbounded plane instead of wrapping at the edges.\n"
+            "\t--seed <number>           : Random number seed, to repeat a run.\n");
 
     rgb_matrix::PrintMatrixFlags(stderr);
 
@@ -104,7 +129,11 @@ int main(int argc, char *argv[]) {
     int scroll_ms = 30;
     uint8_t fade_steps = 50;
 
-    srand(time(NULL));
+    unsigned int seed = time(NULL);
+    PatternLoader patterns;
+    SoupList soups(1000);
+    const char* soupsPath = NULL;
+    bool sparse = false;
  
     RGBMatrix::Options matrix_options;
     rgb_matrix::RuntimeOptions runtime_opt;
@@ -120,8 +149,15 @@ int main(int argc, char *argv[]) {
         return usage(argv[0]);
     }
 
+    static struct option longOptions[] = {
+        { "seed", required_argument, NULL, 'S' },
+        { "soups", required_argument, NULL, 'U' },
+        { "sparse", no_argument, NULL, 'Z' },
+        { NULL, 0, NULL, 0 }
+    };
+
     int opt;
-    while ((opt = getopt(argc, argv, "dD:t:r:f:P:c:p:b:m:LR:")) != -1) {
+    while ((opt = getopt_long(argc, argv, "dD:t:r:f:l:P:c:p:b:m:LR:", longOptions, NULL)) != -1) {
         switch (opt) {
         case 't':
         runtime_seconds = atoi(optarg);
@@ -135,6 +171,13 @@ int main(int argc, char *argv[]) {
         fade_steps = atoi(optarg);
         break;
 
+        case 'l':
+        if (!patterns.load(optarg)) {
+            fprintf(stderr, "Unable to load patterns from %s\n", optarg);
+            return 1;
+        }
+        break;
+
         // These used to be options we understood, but deprecated now. Accept
         // but don't mention in usage()
         case 'R':
@@ -176,11 +219,25 @@ int main(int argc, char *argv[]) {
         matrix_options.brightness = atoi(optarg);
         break;
 
+        case 'S':
+        seed = strtoul(optarg, NULL, 0);
+        break;
+
+        case 'U':
+        soupsPath = optarg;
+        break;
+
+        case 'Z':
+        sparse = true;
+        break;
+
         default: /* '?' */
         return usage(argv[0]);
         }
     }
 
+    srand(seed);
+
     RGBMatrix *matrix = CreateMatrixFromOptions(matrix_options, runtime_opt);
     if (matrix == NULL)
         return 1;
@@ -190,10 +247,20 @@ int main(int argc, char *argv[]) {
 
     Canvas *canvas = matrix;
 
+    if (soupsPath) {
+        if (!soups.load(soupsPath)) {
+            fprintf(stderr, "Unable to load soups from %s\n", soupsPath);
+            return 1;
+        }
+        if (soups.getWidth() != canvas->width() || soups.getHeight() != canvas->height())
+            fprintf(stderr, "Soups were found on a %dx%d grid so will run differently on this display\n",
+                    soups.getWidth(), soups.getHeight());
+    }
+
     // The ThreadedCanvasManipulator objects are filling
     // the matrix continuously.
     ThreadedCanvasManipulator *image_gen = NULL;
-    image_gen = new Animation(canvas, canvas->width(), canvas->height(), scroll_ms, fade_steps);
+    image_gen = new Animation(canvas, canvas->width(), canvas->height(), scroll_ms, fade_steps, &patterns, &soups, sparse);
 
     // Set up an interrupt handler to be able to stop animations while they go
     // on. Note, each demo tests for while (running() && !interrupt_received) {},
@@ -0,0 +1,226 @@
+/**************************************************************************************************
+ * Golden file checker for the animation classes. Runs an animation from a fixed random seed
+ * without any display, and writes or checks the checksum of every frame. Record checksums
+ * before changing an animator, then check them afterwards to prove the changed version still
+ * produces exactly the same frames. It does not use the RGB matrix library, so can be built and
+ * run on any machine.
+ *
+ * For example:
+ *   ./golden -a gol --seed 1 -n 1000 -w gol.golden
+ *   (change and rebuild golife.cpp)
+ *   ./golden -a gol --seed 1 -n 1000 -c gol.golden
+ *
+ * 'make check' checks the golden files kept in the goldens directory. A change which alters the
+ * frames of an animation on purpose should write its golden file again with the same options.
+ *
+ * Written by Paul Fretwell - aka 'Footleg'
+ * 
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ChecksumRenderer.h"
+
+#include "golife.h"      //These are the animation classes which can be checked
+#include "crawler.h"
+#include "crawlerswarm.h"
+#include "fallingsand.h"
+#include "cellularsand.h"
+
+static int usage(const char *progname) {
+    fprintf(stderr, "usage: %s <options> [optional parameter]\n",
+            progname);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr,
+            "\t-a <name>      : Animation to run (gol, crawler, swarm, sand, cellsand).\n"
+            "\t-W <pixels>    : Width of display.\n"
+            "\t-H <pixels>    : Height of display.\n"
+            "\t-n <frames>    : Number of frames to check.\n"
+            "\t--seed <n>     : Random number seed.\n"
+            "\t-w <file>      : Write checksums to golden file.\n"
+            "\t-c <file>      : Check checksums against golden file.\n");
+
+    fprintf(stderr, "Checksums are written to stdout if neither -w or -c are given.\n"
+            "Example:\n\t%s -a sand --seed 1 -n 500 -c sand.golden\n", progname);
+    return 1;
+}
+
+
+int main(int argc, char *argv[]) {
+    const char* name = "gol";
+    const char* writePath = NULL;
+    const char* checkPath = NULL;
+    int width = 32;
+    int height = 32;
+    uint32_t numFrames = 500;
+    uint64_t seed = 1;
+
+    static struct option longOptions[] = {
+        { "seed", required_argument, NULL, 'S' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "a:W:H:n:w:c:", longOptions, NULL)) != -1) {
+        switch (opt) {
+        case 'a':
+        name = optarg;
+        break;
+
+        case 'W':
+        width = atoi(optarg);
+        break;
+
+        case 'H':
+        height = atoi(optarg);
+        break;
+
+        case 'n':
+        numFrames = atoi(optarg);
+        break;
+
+        case 'S':
+        seed = strtoull(optarg, NULL, 0);
+        break;
+
+        case 'w':
+        writePath = optarg;
+        break;
+
+        case 'c':
+        checkPath = optarg;
+        break;
+
+        default: /* '?' */
+        return usage(argv[0]);
+        }
+    }
+
+    if (width < 1 || height < 1)
+        return usage(argv[0]);
+
+    ChecksumRenderer renderer(width, height, seed);
+
+    Animator* animation = NULL;
+    if (strcmp(name, "gol") == 0) {
+        //Start from a random soup, so the soup fill is checked as well as the built in pattern
+        //used after it ends
+        GameOfLife* gol = new GameOfLife(renderer, 1, 0);
+        gol->randomise(seed);
+        animation = gol;
+    }
+    else if (strcmp(name, "crawler") == 0) {
+        animation = new Crawler(renderer);
+    }
+    else if (strcmp(name, "swarm") == 0) {
+        animation = new CrawlerSwarm(renderer, 100);
+    }
+    else if (strcmp(name, "sand") == 0) {
+        FallingSand* sand = new FallingSand(renderer, 5, width * height / 4);
+        sand->setAcceleration(0, -20);
+        for (int i=0; i<width * height / 4; i++)
+            sand->addGrain(renderer.random_uint(1, 216));
+        animation = sand;
+    }
+    else if (strcmp(name, "cellsand") == 0) {
+        CellularSand* sand = new CellularSand(renderer);
+        sand->setAcceleration(0, -1);
+        for (int i=0; i<width * height / 3; i++) {
+            if (i % 2)
+                sand->addWater(renderer.random_uint(1, 216));
+            else
+                sand->addGrain(renderer.random_uint(1, 216));
+        }
+        animation = sand;
+    }
+    else {
+        return usage(argv[0]);
+    }
+
+    FILE* out = stdout;
+    FILE* golden = NULL;
+    if (writePath) {
+        out = fopen(writePath, "w");
+        if (out == NULL) {
+            fprintf(stderr, "Unable to write %s\n", writePath);
+            return 1;
+        }
+    }
+    if (checkPath) {
+        out = NULL;
+        golden = fopen(checkPath, "r");
+        if (golden == NULL) {
+            fprintf(stderr, "Unable to read %s\n", checkPath);
+            return 1;
+        }
+    }
+    if (out)
+        fprintf(out, "# %s %dx%d seed %" PRIu64 "\n", name, width, height, seed);
+
+    //One checksum is checked per cycle, of the last frame shown. Animators which don't show
+    //their own frames are shown once per cycle.
+    int result = 0;
+    uint32_t checked = 0;
+    char line[80];
+    while (renderer.getFrames() < numFrames) {
+        uint32_t frames = renderer.getFrames();
+        animation->runCycle();
+        if (renderer.getFrames() == frames)
+            renderer.showPixels();
+
+        uint32_t frame = renderer.getFrames() - 1;
+        uint64_t checksum = renderer.getChecksum();
+        if (out) {
+            fprintf(out, "%u %016" PRIx64 "\n", frame, checksum);
+        }
+        else {
+            //Find next checksum line in golden file
+            bool found = false;
+            while (fgets(line, sizeof(line), golden)) {
+                if (line[0] != '#') {
+                    found = true;
+                    break;
+                }
+            }
+            uint32_t goldenFrame;
+            uint64_t goldenChecksum;
+            if (!found || sscanf(line, "%u %" SCNx64, &goldenFrame, &goldenChecksum) != 2) {
+                fprintf(stderr, "Golden file ends before frame %u\n", frame);
+                result = 1;
+                break;
+            }
+            if (goldenFrame != frame || goldenChecksum != checksum) {
+                fprintf(stderr, "Mismatch at frame %u: expected frame %u checksum %016" PRIx64 ", got %016" PRIx64 "\n",
+                        frame, goldenFrame, goldenChecksum, checksum);
+                result = 1;
+                break;
+            }
+            checked++;
+        }
+    }
+
+    if (golden) {
+        fclose(golden);
+        if (result == 0)
+            fprintf(stderr, "All %u frames match\n", checked);
+    }
+    if (out && out != stdout)
+        fclose(out);
+    delete animation;
+    return result;
+}
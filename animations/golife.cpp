@@ -30,66 +30,83 @@
 */
 
 #include "golife.h"
+#include "SoupList.h"
+#include "Log.h"
+
+#include <string.h>
+
+//Phases timed when built with FRAME_TIMING
+enum { PHASE_RULES, PHASE_FADE, PHASE_APPLY, PHASE_SLEEP, NUM_PHASES };
+static const char* const timingPhases[NUM_PHASES] = { "rules", "fade", "apply", "sleep" };
+
+//Built in 16x16 patterns, in RLE format
+static const char* const builtinPatterns[] = {
+    "x = 16, y = 16\n$10b2o$10b2o$9bo$10b3o$10b3o4$10b3o$10b3o$9bo$10b2o$10b2o!",
+    "x = 16, y = 16\n2$4bo7bo$3b3o5b3o10$3b3o5b3o$4bo7bo!",
+    "x = 16, y = 16\n4$5b3obo$5bo$8b2o$6b2obo$5bobobo!",
+    "x = 16, y = 16\n4b3o$6bo$5bo2$7b2o$6bo2bo$5bo4bo$4bo6bo$4bo6bo$5bo4bo$6bo2bo$7b2o2$10bo$9bo$9b3o!",
+    "x = 16, y = 16\n4$7b2o$6bo2bo$5bo4bo$4bo6bo$4bo6bo$5bo4bo$6bo2bo$7b2o!",
+    "x = 16, y = 16\n4b3o$6bo$5bo2$7b2o6bo$6bo2bo3bobo$5bo4bo3b2o$4bo6bo$4bo6bo$2o3bo4bo$obo3bo2bo$o6b2o2$10bo$9bo$9b3o!"
+};
+static uint8_t const numBuiltinPatterns = sizeof(builtinPatterns) / sizeof(builtinPatterns[0]);
+
+//Generations run on each tile at a time by jump, and the size of the tiles. A tile with its margins
+//fits in two 80x80 buffers, small enough to stay in the level 1 cache of a Raspberry Pi.
+static int const jumpGenerations = 8;
+static int const jumpTileSize = 64;
+
+//Position of a pattern being placed, passed to placeRun
+struct GameOfLife::PlaceContext {
+    GameOfLife* gol;
+    int x;
+    int y;
+};
 
 // default constructor
 GameOfLife::GameOfLife(RGBMatrixRenderer &renderer_, uint8_t fadeSteps_, int delay_)
     : renderer(renderer_)
 {
-    // Allocate memory
-    cells = new uint8_t*[renderer.getGridWidth()];
-    for (int x=0; x<renderer.getGridWidth(); ++x) {
-        cells[x] = new uint8_t[renderer.getGridHeight()];
+    width = renderer.getGridWidth();
+    height = renderer.getGridHeight();
+
+    // Allocate memory, one row after another
+    cells = new uint8_t[(size_t)width * height];
+    memset(cells, 0, (size_t)width * height);
+    jumpCells = NULL;
+    rowBuffers = new uint8_t[(size_t)width * 4];
+    for (int i=0; i<3; i++) {
+        changes[i] = new uint32_t[(size_t)width * height];
+        numChanges[i] = 0;
     }
 
     //Initialise member variables
     fadeSteps = fadeSteps_;
     delayms = delay_;
 
-    panelSize = renderer.getGridHeight();
-    if (renderer.getGridWidth() < panelSize)
-        panelSize = renderer.getGridWidth();
+    panelSize = (height < width) ? height : width;
+
+    TIMING_INIT(renderer, timingPhases, NUM_PHASES);
 
 } //GameOfLife
 
 // default destructor
 GameOfLife::~GameOfLife()
 {
-    for (int x=0; x<renderer.getGridWidth(); ++x) {
-        delete [] cells[x];
-    }
     delete [] cells;
+    delete [] jumpCells;
+    delete [] rowBuffers;
+    for (int i=0; i<3; i++)
+        delete [] changes[i];
+    TIMING_FREE();
 } //~GameOfLife
 
 void GameOfLife::runCycle()
 {
-    int8_t x, y, xt, yt, xi, yi, neighbours;
-    uint8_t maxRepeatsCount, maxContributor;
+    uint8_t maxContributor;
+    uint32_t maxRepeatsCount = getMaxRepeats(maxContributor);
+    uint8_t endReason = getEndReason();
 
-    //Get highest repeating frame count for repeating patterns > 5 frames
-    maxRepeatsCount = 0;
-    maxContributor = 0;
-    for(int8_t i = 4; i < maxRepeatCycle; ++i)
-    {
-        if ( unchangedPopulation[i] > maxRepeatsCount )
-        {
-            maxRepeatsCount = unchangedPopulation[i];
-            maxContributor = i;
-        }
-    }
-    
-    /* Reinitialise simulation on the following conditions:
-    *  - All cells dead.
-    *  - No changes have occurred between consecutive frames (static pattern)
-    *  - Pattern alternates between just 2 different states 
-    *  - Pattern cycles between 3 different states 
-    *  - Population remains constant at 5 cells for 4xPanel size consecutive frames (gliding pattern)
-    *  - Population remains constant at >5 cells 10xPanel size frames (as glider may collide with something)
-    *  - Population cycles over a 4 step cycle for over 3xPanel size frames
-    *  - Pattern cycles over 6-24 frames for over 150 cycles
-    */
-    if ( (alive == 0) || (unchangedCount > 5 ) || (repeat2Count > 6) || (repeat3Count > 35) 
-        || (unchangedPopulation[0] > panelSize*10) || ( (unchangedPopulation[0] > panelSize*4) && (alive == 5 ) ) 
-        || (unchangedPopulation[3] > panelSize*3) || (maxRepeatsCount > 150) )
+    if (endReason != END_NONE)
     {
         //Update min and max iterations counters
         if (iterations > 0)
@@ -99,39 +116,33 @@ void GameOfLife::runCycle()
 
         }
         //Debug end condition detected
-        char msgEnd[80];
-        if (alive == 0)
-            sprintf(msgEnd, "All died\n");
-        else if (unchangedCount > 5 )
-            sprintf(msgEnd, "Static pattern for 5 frames\n");
-        else if (repeat2Count > 6)
-            sprintf(msgEnd, "Pattern repeated over 2 frames\n");
-        else if (repeat3Count > 35)
-            sprintf(msgEnd, "Pattern repeated over 3 frames\n");
-        else if (unchangedPopulation[0] > panelSize*10)
-        {
-            sprintf(msgEnd, "Population static over %d %s", (panelSize*10), "frames\n");
-        }
-        else if ( (unchangedPopulation[0] > panelSize*4) && (alive == 5 ) )
-        {
-            sprintf(msgEnd, "Population static over %d %s", (panelSize*4), "frames with 5 cells exactly\n");
-        }
-        else if (unchangedPopulation[3] > panelSize*3) 
-        {
-            sprintf(msgEnd, "Population repeated over 4 step cycle %d %s", (panelSize*3), "x\n");
-        }
-        else if (maxRepeatsCount > 150)
-        {
+        char msgEnd[80] = "";
+        if (!LOG_ENABLED(LOG_LEVEL_INFO) || iterations == 0)
+            ; //Reason not needed
+        else if (endReason == END_POPULATION)
+            sprintf(msgEnd, "Population static over %lu %s", (unsigned long)(panelSize*10), "frames\n");
+        else if (endReason == END_GLIDER)
+            sprintf(msgEnd, "Population static over %lu %s", (unsigned long)(panelSize*4), "frames with 5 cells exactly\n");
+        else if (endReason == END_CYCLE4)
+            sprintf(msgEnd, "Population repeated over 4 step cycle %lu %s", (unsigned long)(panelSize*3), "x\n");
+        else if (endReason == END_CYCLE)
             sprintf(msgEnd, "Population repeated over %d %s", (maxContributor+1), "step cycle 150x\n");
-        }
+        else
+            sprintf(msgEnd, "%s\n", getEndReasonName(endReason));
         
-        char msg[255];
-        sprintf(msg, "Pattern terminated after %lu iterations (min: %lu, max: %lu): %s",
-                iterations, iterationsMin, iterationsMax, msgEnd);
         if (iterations > 0)
-            renderer.outputMessage(msg);
+            LOG_INFO(renderer, "Pattern terminated after %lu iterations (min: %lu, max: %lu): %s",
+                     (unsigned long)iterations, (unsigned long)iterationsMin, (unsigned long)iterationsMax, msgEnd);
 
-        initialiseGrid(6);
+        if (soups && soups->getCount() > 0)
+        {
+            //Replay the next long lived soup found by a soup search
+            if (nextSoup >= soups->getCount())
+                nextSoup = 0;
+            randomise(soups->getSoup(nextSoup++).seed);
+        }
+        else
+            initialiseGrid(6);
         
     }
 
@@ -140,64 +151,345 @@ void GameOfLife::runCycle()
         || (unchangedPopulation[3] > 10) || (maxRepeatsCount > 20) ) )
     {
         //Debug delay
+        TIMING_START(PHASE_SLEEP);
         renderer.msSleep(100);
+        TIMING_STOP(PHASE_SLEEP);
     }
 
     //Apply rules of Game of Life to determine cells dying and being born
-    for(y = 0; y < renderer.getGridHeight(); ++y)
+    TIMING_START(PHASE_RULES);
+    findChanges();
+    TIMING_STOP(PHASE_RULES);
+
+    //Fade cells in/out for births/deaths if fade steps set
+    if (fadeSteps > 1) {
+        TIMING_START(PHASE_FADE);
+        fadeInChanges();
+        TIMING_STOP(PHASE_FADE);
+    }
+
+    TIMING_START(PHASE_APPLY);
+    applyChanges();
+    TIMING_STOP(PHASE_APPLY);
+    
+    if (alive == 0)
+    {
+      //Pause to show end of population before it gets reset
+      TIMING_START(PHASE_SLEEP);
+      renderer.msSleep(4000); 
+      TIMING_STOP(PHASE_SLEEP);
+    }
+
+    iterations++;
+    TIMING_FRAME();
+}
+
+//Run up to the given number of generations without drawing them, then draw the final state. Stops
+//early if the pattern dies out or starts repeating, leaving it to be reset by the next runCycle.
+//Returns the number of generations run.
+uint32_t GameOfLife::advance(uint32_t generations)
+{
+    uint32_t n = 0;
+    while (n < generations && !isFinished())
     {
-        for(x = 0; x < renderer.getGridWidth(); ++x)
+        findChanges();
+        applyChanges(false);
+        iterations++;
+        n++;
+    }
+    drawCells();
+    return n;
+}
+
+//Run a number of generations as fast as possible, without drawing them or checking for the end of
+//the run, then draw the final state. The grid is split into tiles which are each run for several
+//generations while they are in the cache, using a copy of the tile with a margin of cells around
+//it as wide as the number of generations. The result is exactly the same as running the
+//generations one at a time. End conditions are only detected from the generations after a jump.
+void GameOfLife::jump(uint32_t generations)
+{
+    if (jumpCells == NULL)
+        jumpCells = new uint8_t[(size_t)width * height];
+    int bufferSize = jumpTileSize + 2 * jumpGenerations;
+    uint8_t* tiles[2];
+    tiles[0] = new uint8_t[bufferSize * bufferSize];
+    tiles[1] = new uint8_t[bufferSize * bufferSize];
+
+    uint32_t done = 0;
+    while (done < generations)
+    {
+        int k = (generations - done < jumpGenerations) ? generations - done : jumpGenerations;
+        alive = 0;
+        for (int ty = 0; ty < height; ty += jumpTileSize)
         {
-            //For each cell, count neighbours, including wrapping over grid edges
-            neighbours = -1;
-            for(xi = -1; xi < 2; ++xi)
+            int th = (height - ty < jumpTileSize) ? height - ty : jumpTileSize;
+            for (int tx = 0; tx < width; tx += jumpTileSize)
             {
-                xt = renderer.newPositionX(x, xi);
-                for(yi = -1; yi < 2; ++yi)
+                int tw = (width - tx < jumpTileSize) ? width - tx : jumpTileSize;
+                int w = tw + 2 * k;
+                int h = th + 2 * k;
+
+                //Copy the tile and its margins, wrapping over the grid edges as often as needed
+                int sx0 = (tx - k) % width;
+                if (sx0 < 0) sx0 += width;
+                int sy = (ty - k) % height;
+                if (sy < 0) sy += height;
+                for (int y = 0; y < h; ++y)
                 {
-                    yt = renderer.newPositionY(y, yi);
-                    if ( (cells[xt][yt] & CELL_ALIVE) != 0 )
+                    const uint8_t* src = cells + (size_t)sy * width;
+                    uint8_t* dst = tiles[0] + y * bufferSize;
+                    int sx = sx0;
+                    for (int x = 0; x < w; ++x)
                     {
-                        ++neighbours;
+                        dst[x] = src[sx];
+                        if (++sx == width) sx = 0;
                     }
+                    if (++sy == height) sy = 0;
                 }
-            }
 
-            //Reset changes arrays for this cell
-            cells[x][y] &= ~CELL_BIRTH;
-            cells[x][y] &= ~CELL_DEATH;
-            if ( ((cells[x][y] & CELL_ALIVE) != 0) && (neighbours < 2) )
-            {
-                //Populated cell with too few neighbours, so it will die
-                cells[x][y] |= CELL_DEATH; //turn on kill bit
+                //Each generation leaves one less cell of margin correct
+                for (int g = 1; g <= k; ++g)
+                    stepTile(tiles[(g - 1) & 1], tiles[g & 1], w, h, bufferSize, g);
 
+                const uint8_t* result = tiles[k & 1];
+                for (int y = 0; y < th; ++y)
+                {
+                    const uint8_t* src = result + (y + k) * bufferSize + k;
+                    uint8_t* dst = jumpCells + (size_t)(ty + y) * width + tx;
+                    for (int x = 0; x < tw; ++x)
+                    {
+                        dst[x] = src[x];
+                        alive += src[x];
+                    }
+                }
             }
-            else if ( ((cells[x][y] & CELL_ALIVE) == 0) && (neighbours == 2) ) 
-            {
-                //Empty cell with exactly 3 neighbours (count = 2 as did not count itself so was initialised as -1)
-                cells[x][y] |= CELL_BIRTH; //turn on spawn bit
-            }
-            else if ( ((cells[x][y] & CELL_ALIVE) != 0) && (neighbours > 3) )
+        }
+
+        uint8_t* swap = cells;
+        cells = jumpCells;
+        jumpCells = swap;
+        done += k;
+    }
+
+    delete [] tiles[0];
+    delete [] tiles[1];
+    iterations += generations;
+    resetHistory();
+    drawCells();
+}
+
+//Run one generation of the cells in a tile more than margin cells in from its edges
+void GameOfLife::stepTile(const uint8_t* src, uint8_t* dst, int w, int h, int stride, int margin)
+{
+    for (int y = margin; y < h - margin; ++y)
+    {
+        const uint8_t* above = src + (y - 1) * stride;
+        const uint8_t* row = src + y * stride;
+        const uint8_t* below = src + (y + 1) * stride;
+        uint8_t* out = dst + y * stride;
+        for (int x = margin; x < w - margin; ++x)
+        {
+            //Cells are 0 or CELL_ALIVE (1). The total includes the cell itself.
+            uint8_t total = above[x - 1] + above[x] + above[x + 1] + row[x - 1] + row[x] + row[x + 1]
+                          + below[x - 1] + below[x] + below[x + 1];
+            out[x] = (total == 3) | (row[x] & (total == 4));
+        }
+    }
+}
+
+//True when the pattern has died out or settled into a repeating cycle, so would be reset by the
+//next call to runCycle
+bool GameOfLife::isFinished()
+{
+    return getEndReason() != END_NONE;
+}
+
+/* The simulation is finished and gets reinitialised on the following conditions:
+*  - All cells dead.
+*  - No changes have occurred between consecutive frames (static pattern)
+*  - Pattern alternates between just 2 different states 
+*  - Pattern cycles between 3 different states 
+*  - Population remains constant at 5 cells for 4xPanel size consecutive frames (gliding pattern)
+*  - Population remains constant at >5 cells 10xPanel size frames (as glider may collide with something)
+*  - Population cycles over a 4 step cycle for over 3xPanel size frames
+*  - Pattern cycles over 6-24 frames for over 150 cycles
+*/
+uint8_t GameOfLife::getEndReason()
+{
+    uint8_t maxContributor;
+    uint32_t maxRepeatsCount = getMaxRepeats(maxContributor);
+
+    if (alive == 0)
+        return END_DIED;
+    else if (unchangedCount > 5)
+        return END_STATIC;
+    else if (repeat2Count > 6)
+        return END_REPEAT2;
+    else if (repeat3Count > 35)
+        return END_REPEAT3;
+    else if (unchangedPopulation[0] > panelSize*10)
+        return END_POPULATION;
+    else if ( (unchangedPopulation[0] > panelSize*4) && (alive == 5) )
+        return END_GLIDER;
+    else if (unchangedPopulation[3] > panelSize*3)
+        return END_CYCLE4;
+    else if (maxRepeatsCount > 150)
+        return END_CYCLE;
+    return END_NONE;
+}
+
+const char* GameOfLife::getEndReasonName(uint8_t reason)
+{
+    switch (reason)
+    {
+        case END_DIED: return "All died";
+        case END_STATIC: return "Static pattern for 5 frames";
+        case END_REPEAT2: return "Pattern repeated over 2 frames";
+        case END_REPEAT3: return "Pattern repeated over 3 frames";
+        case END_POPULATION: return "Population static";
+        case END_GLIDER: return "Population static with 5 cells exactly";
+        case END_CYCLE4: return "Population repeated over 4 step cycle";
+        case END_CYCLE: return "Population repeated over longer cycle";
+    }
+    return "Running";
+}
+
+//Get highest repeating frame count for repeating patterns > 5 frames, and the cycle length - 1
+uint32_t GameOfLife::getMaxRepeats(uint8_t &maxContributor)
+{
+    uint32_t maxRepeatsCount = 0;
+    maxContributor = 0;
+    for(uint8_t i = 4; i < maxRepeatCycle; ++i)
+    {
+        if ( unchangedPopulation[i] > maxRepeatsCount )
+        {
+            maxRepeatsCount = unchangedPopulation[i];
+            maxContributor = i;
+        }
+    }
+    return maxRepeatsCount;
+}
+
+//Work out the next generation and update the grid to it in a single pass, listing the cells born
+//or dying in grid order. Each row is copied before it is updated, so its neighbours in the next
+//row still see the old state. The list is compared with the previous two as it is made, to find
+//repeating patterns without going over the lists again.
+void GameOfLife::findChanges()
+{
+    //Keep the lists for the last two generations, to detect repeats
+    if (changesApplied)
+    {
+        uint32_t* oldest = changes[2];
+        changes[2] = changes[1];
+        changes[1] = changes[0];
+        changes[0] = oldest;
+        numChanges[2] = numChanges[1];
+        numChanges[1] = numChanges[0];
+        if (historyLength < 2) ++historyLength;
+    }
+    uint32_t* changed = changes[0];
+    uint32_t numChanged = 0;
+    bool same2 = (historyLength >= 1);
+    bool cancel3 = (historyLength >= 2);
+    uint32_t n1 = 0, n2 = 0;
+
+    //Cells are 0 or CELL_ALIVE (1), so neighbours are counted by adding them up. The first row is
+    //kept as the last row wraps round to it after it has been updated.
+    uint8_t* firstRow = rowBuffers;
+    uint8_t* prevRow = rowBuffers + width;
+    uint8_t* curRow = rowBuffers + 2 * width;
+    uint8_t* colSums = rowBuffers + 3 * width;
+    memcpy(firstRow, cells, width);
+
+    for (int y = 0; y < height; ++y)
+    {
+        uint8_t* row = cells + (size_t)y * width;
+        memcpy(curRow, row, width);
+        const uint8_t* above = (y > 0) ? prevRow : ((height > 1) ? cells + (size_t)(height - 1) * width : firstRow);
+        const uint8_t* below = (y + 1 < height) ? row + width : firstRow;
+
+        //Live cells in each column of the 3 rows around this one
+        for (int x = 0; x < width; ++x)
+            colSums[x] = above[x] + curRow[x] + below[x];
+
+        for (int x = 0; x < width; ++x)
+        {
+            int left = (x > 0) ? x - 1 : width - 1;
+            int right = (x + 1 < width) ? x + 1 : 0;
+            uint8_t neighbours = colSums[left] + colSums[x] + colSums[right] - curRow[x];
+            bool wasAlive = (curRow[x] != 0);
+            if ( wasAlive ? (neighbours == 2 || neighbours == 3) : (neighbours != 3) )
+                continue;
+
+            //Cell is born with exactly 3 neighbours, or dies with too few or too many
+            uint32_t i = (uint32_t)y * width + x;
+            row[x] ^= CELL_ALIVE;
+            if (wasAlive) --alive; else ++alive;
+
+            //Same as 2 iterations ago if the same cells changed last time
+            if (same2)
+                same2 = (numChanged < numChanges[1] && changes[1][numChanged] == i);
+            //Same as 3 iterations ago if each cell changed an even number of times in the 3 lists
+            if (cancel3)
             {
-                //Populated cell with too many neighbours, so it will die
-                cells[x][y] |= CELL_DEATH; //turn on kill bit
+                cancel3 = pairedUpTo(i, n1, n2);
+                bool in1 = (n1 < numChanges[1] && changes[1][n1] == i);
+                bool in2 = (n2 < numChanges[2] && changes[2][n2] == i);
+                if (in1 == in2)
+                    cancel3 = false;
+                n1 += in1;
+                n2 += in2;
             }
+            changed[numChanged++] = i;
         }
+
+        uint8_t* swap = prevRow;
+        prevRow = curRow;
+        curRow = swap;
     }
 
-    //Fade cells in/out for births/deaths if fade steps set
-    if (fadeSteps > 1)
-        fadeInChanges();
+    numChanges[0] = numChanged;
+    changesApplied = true;
+    repeated2 = same2 && (numChanged == numChanges[1]);
+    repeated3 = cancel3 && pairedUpTo(UINT32_MAX, n1, n2);
+}
 
-    applyChanges();
-    
-    if (alive == 0)
+//Step through the change lists of the previous two iterations up to cell i. Cells before i did not
+//change in this iteration, so must be in both lists for the changes to cancel out.
+bool GameOfLife::pairedUpTo(uint32_t i, uint32_t &n1, uint32_t &n2)
+{
+    while (true)
     {
-      //Pause to show end of population before it gets reset
-      renderer.msSleep(4000); 
+        uint32_t c1 = (n1 < numChanges[1]) ? changes[1][n1] : UINT32_MAX;
+        uint32_t c2 = (n2 < numChanges[2]) ? changes[2][n2] : UINT32_MAX;
+        if (c1 >= i && c2 >= i)
+            return true;
+        if (c1 != c2)
+            return false;
+        ++n1;
+        ++n2;
     }
+}
 
-    iterations++;
+//Draw every cell in its current state
+void GameOfLife::drawCells()
+{
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            if ((cells[(size_t)y * width + x] & CELL_ALIVE) != 0)
+                renderer.setPixel(x, y, renderer.r, renderer.g, renderer.b);
+            else
+                renderer.setPixel(x, y, 0, 0, 0);
+        }
+    }
+}
+
+//Set percentage of cells alive when a random pattern is generated
+void GameOfLife::setDensity(uint8_t percent)
+{
+    density = (percent > 100) ? 100 : percent;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -205,16 +497,164 @@ void GameOfLife::runCycle()
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 void GameOfLife::initialiseGrid(uint8_t patternIdx)
 {
-    const bool X = true;
-    const bool O = false;
+    startRun();
+
+    if (patternIdx == 0) {
+        //Random, from a seed which can be passed to randomise to repeat the same soup
+        uint64_t seed = 0;
+        for (int i=0; i<4; i++)
+            seed = (seed << 16) | renderer.random_uint(0,65535);
+        LOG_DEBUG(renderer, "Random soup seed %llu\n", (unsigned long long)seed);
+        fillRandom(seed);
+    }
+    else
+    {
+        //Loaded patterns are used in turn in place of the built in patterns
+        PatternLoader::Pattern builtin;
+        const PatternLoader::Pattern* pattern = &builtin;
+        if (patterns && patterns->getCount() > 0) {
+            if (nextPattern >= patterns->getCount())
+                nextPattern = 0;
+            pattern = &patterns->getPattern(nextPattern++);
+        }
+        else {
+            const char* text = builtinPatterns[(patternIdx - 1) % numBuiltinPatterns];
+            PatternLoader::scan(text, strlen(text), builtin);
+        }
+
+        //Set up pattern in the centre of the grid
+        clearCells();
+        placeCells(*pattern, (renderer.getGridWidth() - pattern->width) / 2,
+                   renderer.getGridHeight() - pattern->height - (renderer.getGridHeight() - pattern->height) / 2);
+    }
 
+}
+
+//Start a new run from a random soup. The same seed always gives the same soup for a given grid
+//size, density and symmetry.
+void GameOfLife::randomise(uint64_t seed)
+{
+    startRun();
+    fillRandom(seed);
+}
+
+//SplitMix64 generator, so soups do not depend on the renderer random numbers
+static uint64_t nextRandom(uint64_t &state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+//Fill the grid with a random soup, 64 cells at a time, then draw it. Each cell gets a random 16
+//bit fraction, made from one bit of each of up to 16 random words, and is alive if it is below
+//the density. The bits are compared from the lowest up, so each word decides whether 64 fractions
+//are below the density so far.
+void GameOfLife::fillRandom(uint64_t seed)
+{
+    uint64_t state = seed;
+    uint32_t threshold = ((uint32_t)density * 65536 + 50) / 100;
+    uint8_t lowestBit = 0;
+    while (lowestBit < 16 && ((threshold >> lowestBit) & 1) == 0)
+        ++lowestBit;
+
+    size_t numCells = (size_t)width * height;
+    alive = 0;
+    for (size_t i = 0; i < numCells; i += 64)
+    {
+        uint64_t below = (threshold > 0xFFFF) ? ~0ULL : 0;
+        for (uint8_t bit = lowestBit; bit < 16; ++bit)
+        {
+            uint64_t random = nextRandom(state);
+            if ((threshold >> bit) & 1)
+                below |= ~random;
+            else
+                below &= ~random;
+        }
+
+        size_t n = (numCells - i < 64) ? numCells - i : 64;
+        if (n < 64)
+            below &= ((uint64_t)1 << n) - 1;
+        uint8_t* cell = cells + i;
+        for (size_t j = 0; j < n; ++j)
+            cell[j] = (below >> j) & CELL_ALIVE;
+        alive += __builtin_popcountll(below);
+    }
+
+    if (symmetry != SYMMETRY_NONE)
+    {
+        applySymmetry();
+        alive = 0;
+        for (size_t i = 0; i < numCells; ++i)
+            alive += cells[i];
+    }
+    drawCells();
+}
+
+//Copy one part of a random soup over the rest to make it symmetrical
+void GameOfLife::applySymmetry()
+{
+    if (symmetry == SYMMETRY_MIRROR_X || symmetry == SYMMETRY_MIRROR_XY)
+    {
+        //Right half is a mirror image of the left
+        for (int y = 0; y < height; ++y)
+        {
+            uint8_t* row = cells + (size_t)y * width;
+            for (int x = 0; x < width / 2; ++x)
+                row[width - 1 - x] = row[x];
+        }
+    }
+    if (symmetry == SYMMETRY_MIRROR_Y || symmetry == SYMMETRY_MIRROR_XY)
+    {
+        //Top half is a mirror image of the bottom
+        for (int y = 0; y < height / 2; ++y)
+            memcpy(cells + (size_t)(height - 1 - y) * width, cells + (size_t)y * width, width);
+    }
+    if (symmetry == SYMMETRY_ROTATE_180)
+    {
+        //Top half is the bottom half turned upside down
+        size_t numCells = (size_t)width * height;
+        for (size_t i = 0; i < numCells / 2; ++i)
+            cells[numCells - 1 - i] = cells[i];
+    }
+}
+
+//Set the symmetry of random soups, one of the SYMMETRY_ values
+void GameOfLife::setSymmetry(uint8_t symmetry_)
+{
+    symmetry = (symmetry_ < NUM_SYMMETRIES) ? symmetry_ : SYMMETRY_NONE;
+}
+
+const char* GameOfLife::getSymmetryName(uint8_t symmetry)
+{
+    switch (symmetry)
+    {
+        case SYMMETRY_MIRROR_X: return "mirrorx";
+        case SYMMETRY_MIRROR_Y: return "mirrory";
+        case SYMMETRY_MIRROR_XY: return "mirrorxy";
+        case SYMMETRY_ROTATE_180: return "rotate180";
+    }
+    return "none";
+}
+
+//Find a symmetry from its name. Returns NUM_SYMMETRIES if the name is not known.
+uint8_t GameOfLife::findSymmetry(const char* name)
+{
+    for (uint8_t i = 0; i < NUM_SYMMETRIES; ++i)
+    {
+        if (strcmp(name, getSymmetryName(i)) == 0)
+            return i;
+    }
+    return NUM_SYMMETRIES;
+}
+
+//Reset end condition counters and pick a new colour for the next run
+void GameOfLife::startRun()
+{
     alive = 0;
     iterations = 0;
-    unchangedCount = 0;
-    for (int x = 0; x < maxRepeatCycle; ++x) unchangedPopulation[x] = 0;
-    repeat2Count = 0;
-    repeat3Count = 0;
-    for (int x = 0; x < popHistorySize; ++x) population[x] = 0;
+    resetHistory();
 
     //New random colour
     renderer.setRandomColour();
@@ -224,273 +664,119 @@ void GameOfLife::initialiseGrid(uint8_t patternIdx)
             || (renderer.r < 100 && renderer.g > 180 && renderer.b < 100) ) 
             renderer.setRandomColour();
     }
+}
 
-    if (patternIdx == 0) {
-        //Random
-        for(int y = 0; y < renderer.getGridHeight(); ++y)
+//Forget the previous generations used to detect the end of a run
+void GameOfLife::resetHistory()
+{
+    unchangedCount = 0;
+    for (int x = 0; x < maxRepeatCycle; ++x) unchangedPopulation[x] = 0;
+    repeat2Count = 0;
+    repeat3Count = 0;
+    for (int x = 0; x < popHistorySize; ++x) population[x] = 0;
+    numChanges[0] = 0;
+    historyLength = 0;
+    changesApplied = false;
+    repeated2 = false;
+    repeated3 = false;
+}
+
+//Kill all cells
+void GameOfLife::clearCells()
+{
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
         {
-            for(int x = 0; x < renderer.getGridWidth(); ++x)
-            {
-                uint8_t randNumber = renderer.random_uint(0,100);
-                if (randNumber < 15)
-                {
-                    cells[x][y] = CELL_ALIVE;
-                    renderer.setPixel(x, y, renderer.r, renderer.g, renderer.b);
-                    alive++;
-                }
-                else
-                {
-                    cells[x][y] = 0;
-                    renderer.setPixel(x, y, 0, 0, 0);
-                }
-            }
+            cells[(size_t)y * width + x] = 0;
+            renderer.setPixel(x, y, 0, 0, 0);
         }
     }
-    else
-    {
-        bool pattern[256] = {O};
+    alive = 0;
+}
 
-        
-        switch(patternIdx)
-        {
-            case 1:
-            {
-                bool patternAlt[] = {
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,X,X,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,X,X,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,X,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,X,X,X,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,X,X,X,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,X,X,X,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,X,X,X,O,O,O,
-                O,O,O,O,O,O,O,O,O,X,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,X,X,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,X,X,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O };
-                
-                for (int i=0; i < 256; i++) pattern[i] = patternAlt[i];
-            }
-            break;
+//Replay soups from a soup search when the simulation is reset, instead of the built in pattern.
+//The soups should have been found on a grid of the same size. The list must not be deleted while
+//it is in use.
+void GameOfLife::setSoups(SoupList* list)
+{
+    soups = list;
+    nextSoup = 0;
+    if (soups && soups->getCount() > 0) {
+        setDensity(soups->getDensity());
+        setSymmetry(soups->getSymmetry());
+    }
+}
 
-            case 2:
-            {
-                bool patternAlt[] = {
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,X,O,O,O,O,O,O,O,X,O,O,O,
-                O,O,O,X,X,X,O,O,O,O,O,X,X,X,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,X,X,X,O,O,O,O,O,X,X,X,O,O,
-                O,O,O,O,X,O,O,O,O,O,O,O,X,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O };
-
-                for (int i=0; i < 256; i++) pattern[i] = patternAlt[i];                    
-            }
-            break;
+//Use patterns from a loader when the simulation is reset, instead of the built in patterns.
+//The loader must not be deleted while it is in use.
+void GameOfLife::setPatterns(PatternLoader* loader)
+{
+    patterns = loader;
+    nextPattern = 0;
+}
 
-            case 3:
-            {
-                bool patternAlt[] = {
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,X,X,X,O,X,O,O,O,O,O,O,
-                O,O,O,O,O,X,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,X,X,O,O,O,O,O,O,
-                O,O,O,O,O,O,X,X,O,X,O,O,O,O,O,O,
-                O,O,O,O,O,X,O,X,O,X,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O };
-
-                for (int i=0; i < 256; i++) pattern[i] = patternAlt[i];
-            }
-            break;
-                
-            case 4:
-            {
-                bool patternAlt[] = {
-                O,O,O,O,X,X,X,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,X,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,X,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,X,X,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,X,O,O,X,O,O,O,O,O,O,
-                O,O,O,O,O,X,O,O,O,O,X,O,O,O,O,O,
-                O,O,O,O,X,O,O,O,O,O,O,X,O,O,O,O,
-                O,O,O,O,X,O,O,O,O,O,O,X,O,O,O,O,
-                O,O,O,O,O,X,O,O,O,O,X,O,O,O,O,O,
-                O,O,O,O,O,O,X,O,O,X,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,X,X,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,X,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,X,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,X,X,X,O,O,O,O };
-
-                for (int i=0; i < 256; i++) pattern[i] = patternAlt[i];
-            }
-            break;
-                
-            case 5:
-            {
-                bool patternAlt[] = {
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,X,X,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,X,O,O,X,O,O,O,O,O,O,
-                O,O,O,O,O,X,O,O,O,O,X,O,O,O,O,O,
-                O,O,O,O,X,O,O,O,O,O,O,X,O,O,O,O,
-                O,O,O,O,X,O,O,O,O,O,O,X,O,O,O,O,
-                O,O,O,O,O,X,O,O,O,O,X,O,O,O,O,O,
-                O,O,O,O,O,O,X,O,O,X,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,X,X,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O };
-
-                for (int i=0; i < 256; i++) pattern[i] = patternAlt[i];
-            }
-            break;
-                
-            case 6:
-            {
-                bool patternAlt[] = {
-                O,O,O,O,X,X,X,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,X,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,X,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,X,X,O,O,O,O,O,O,X,
-                O,O,O,O,O,O,X,O,O,X,O,O,O,X,O,X,
-                O,O,O,O,O,X,O,O,O,O,X,O,O,O,X,X,
-                O,O,O,O,X,O,O,O,O,O,O,X,O,O,O,O,
-                O,O,O,O,X,O,O,O,O,O,O,X,O,O,O,O,
-                X,X,O,O,O,X,O,O,O,O,X,O,O,O,O,O,
-                X,O,X,O,O,O,X,O,O,X,O,O,O,O,O,O,
-                X,O,O,O,O,O,O,X,X,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,O,X,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,X,O,O,O,O,O,O,
-                O,O,O,O,O,O,O,O,O,X,X,X,O,O,O,O };
-
-                for (int i=0; i < 256; i++) pattern[i] = patternAlt[i];
-            }
-            break;
-                
-        }
+//Place a pattern with its top left corner at x,y, counting down from the top of the grid. Cells
+//over the edges wrap around. The grid is cleared first and a new run started unless clear is false.
+void GameOfLife::placePattern(const PatternLoader::Pattern &pattern, int x, int y, bool clear)
+{
+    if (clear) {
+        startRun();
+        clearCells();
+    }
+    placeCells(pattern, x, y);
+}
 
-        //Set up pattern
-        int offsetX = (renderer.getGridWidth() - 16) / 2;
-        int offsetY = (renderer.getGridHeight() - 16) / 2;
-        for(int y = 0; y < renderer.getGridHeight(); ++y)
+void GameOfLife::placeCells(const PatternLoader::Pattern &pattern, int x, int y)
+{
+    PlaceContext context = { this, x, y };
+    PatternLoader::decode(pattern, placeRun, &context);
+}
+
+//Set a run of cells decoded from a pattern alive
+void GameOfLife::placeRun(void* context_, int x, int y, int count)
+{
+    PlaceContext &context = *(PlaceContext*)context_;
+    GameOfLife &gol = *context.gol;
+    int width = gol.width;
+    int height = gol.height;
+
+    int gy = (context.y + y) % height;
+    if (gy < 0) gy += height;
+    gy = height - 1 - gy;
+    int gx = (context.x + x) % width;
+    if (gx < 0) gx += width;
+    uint8_t* row = gol.cells + (size_t)gy * width;
+    for (int i = 0; i < count; ++i)
+    {
+        if ((row[gx] & CELL_ALIVE) == 0)
         {
-            if ( (y >= offsetY) && (y < offsetY+16) )
-            {
-                for(int x = 0; x < renderer.getGridWidth(); ++x)
-                { 
-                    if ( (x >= offsetX) && (x < offsetX+16) 
-                        && (pattern[(16 - 1 - y+offsetY)*16 + x-offsetX]) ) 
-                    {
-                        cells[x][y] |= CELL_ALIVE;
-                        renderer.setPixel(x, y, renderer.r, renderer.g, renderer.b);
-                        alive++;
-                    }
-                    else 
-                    {
-                        //Clear cells in pattern
-                        cells[x][y] &= ~CELL_ALIVE;
-                        renderer.setPixel(x, y, 0,0,0);
-                    }
-                }
-            }
-            else 
-            {
-                for(int x = 0; x < renderer.getGridWidth(); ++x)
-                { 
-                    //Clear cells outside pattern
-                    cells[x][y] &= ~CELL_ALIVE;
-                    renderer.setPixel(x, y, 0,0,0);
-                }
-            }
+            row[gx] |= CELL_ALIVE;
+            gol.renderer.setPixel(gx, gy, gol.renderer.r, gol.renderer.g, gol.renderer.b);
+            gol.alive++;
         }
+        if (++gx == width) gx = 0;
     }
-
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-// Update cells array with changes for next iteration
+// Show changes made to the cells array and update the end condition counters
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-void GameOfLife::applyChanges()
+void GameOfLife::applyChanges(bool show)
 {
-    uint8_t changes, gap;
-    int8_t popChk,prevPopChk;
-    
-    changes = 0;
-    bool compare2 = true;
-    bool compare3 = true;
+    uint8_t gap;
+    int popChk,prevPopChk;
 
-    for(int y = 0; y < renderer.getGridHeight(); ++y)
+    //The grid already holds the new generation, so only the changed cells need drawing
+    if (show && fadeSteps < 2)
     {
-        for(int x = 0; x < renderer.getGridWidth(); ++x)
+        for (uint32_t c = 0; c < numChanges[0]; ++c)
         {
-            //Update last 3 iterations history for this cell
-            if ((cells[x][y] & CELL_PREV2) != 0)
-                cells[x][y] |= CELL_PREV3;
-            else
-                cells[x][y] &= ~CELL_PREV3;
-            
-            if ((cells[x][y] & CELL_PREV1) != 0)
-                cells[x][y] |= CELL_PREV2;
-            else
-                cells[x][y] &= ~CELL_PREV2;
-
-            if ((cells[x][y] & CELL_ALIVE) != 0)
-                cells[x][y] |= CELL_PREV1;
+            uint32_t i = changes[0][c];
+            if ((cells[i] & CELL_ALIVE) != 0)
+                renderer.setPixel(i % width, i / width, renderer.r, renderer.g, renderer.b);
             else
-                cells[x][y] &= ~CELL_PREV1;
-
-            //Create new cells
-            if ((cells[x][y] & CELL_BIRTH) != 0)
-            {
-                cells[x][y] |= CELL_ALIVE;
-                if (fadeSteps < 2) 
-                    renderer.setPixel(x, y, renderer.r, renderer.g, renderer.b);
-                ++changes;
-                ++alive;
-            }
-            else if ((cells[x][y] & CELL_DEATH) != 0)
-            {
-                //Kill dying cells
-                cells[x][y] &= ~CELL_ALIVE;
-                if (fadeSteps < 2) 
-                    renderer.setPixel(x, y, 0, 0, 0);
-                ++changes;
-                --alive;
-            }
-            
-            //Compare cell to state 2 and 3 iterations ago
-            if (compare2 && ( ((cells[x][y] & CELL_ALIVE) == 0) != ((cells[x][y] & CELL_PREV2) == 0) )) compare2 = false;
-            if (compare3 && ( ((cells[x][y] & CELL_ALIVE) == 0) != ((cells[x][y] & CELL_PREV3) == 0) )) compare3 = false;
+                renderer.setPixel(i % width, i / width, 0, 0, 0);
         }
     }
 
@@ -499,19 +785,19 @@ void GameOfLife::applyChanges()
     population[popCursor] = alive;
     
     //Increment counter if no changes made
-    if (changes == 0)
+    if (numChanges[0] == 0)
         ++unchangedCount;
     else
         unchangedCount = 0;
 
     //Increment counter if last frame was identical to 2 frames ago (2 cycle repeat)
-    if (compare2)
+    if (repeated2)
         ++repeat2Count;
     else
         repeat2Count = 0;
 
     //Increment counter if last frame was identical to 3 frames ago (3 cycle repeat)
-    if (compare3)
+    if (repeated3)
         ++repeat3Count;
     else
         repeat3Count = 0;
@@ -555,8 +841,9 @@ void GameOfLife::applyChanges()
         if (gapCheck == true) break;
     }
 
+    //When no cycle repeats, gap is past the end of the counters so reset them all
     if (gapCheck == true) ++unchangedPopulation[gap-1];
-    else unchangedPopulation[gap-1] = 0;
+    else for (gap = 4; gap < maxRepeatCycle+1; ++gap) unchangedPopulation[gap-1] = 0;
   
 }
 
@@ -599,23 +886,26 @@ void GameOfLife::fadeInChanges()
             dB = 0;
         }
         
-        for(int y = 0; y < renderer.getGridHeight(); ++y)
+        //Cells changing which are now alive are being born, the others are dying
+        for (uint32_t c = 0; c < numChanges[0]; ++c)
         {
-            for(int x = 0; x < renderer.getGridWidth(); ++x)
+            uint32_t cell = changes[0][c];
+            if ((cells[cell] & CELL_ALIVE) != 0)
             {
-                if ((cells[x][y] & CELL_BIRTH) != 0)
-                {
-                    renderer.setPixel(x, y, bR, bG, bB);
-                }
-                else if ((cells[x][y] & CELL_DEATH) != 0)
-                {
-                    renderer.setPixel(x, y, dR, dG, dB);
-                }
+                renderer.setPixel(cell % width, cell / width, bR, bG, bB);
+            }
+            else
+            {
+                renderer.setPixel(cell % width, cell / width, dR, dG, dB);
             }
         }
         
         if (delayms * fadeSteps > 1000) fadeDelay = 1000 / fadeSteps;
         renderer.showPixels();
+        TIMING_STOP(PHASE_FADE);
+        TIMING_START(PHASE_SLEEP);
         renderer.msSleep(fadeDelay);
+        TIMING_STOP(PHASE_SLEEP);
+        TIMING_START(PHASE_FADE);
     }
 }
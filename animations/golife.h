@@ -38,44 +38,105 @@
 #endif
 
 #include "RGBMatrixRenderer.h"
+#include "Animator.h"
+#include "PatternLoader.h"
+#include "FrameTimer.h"
 
-class GameOfLife
+class SoupList;
+
+class GameOfLife : public Animator
 {
     //variables
     public:
+        //Reasons a run ends, in the order they are checked
+        static uint8_t const END_NONE = 0;
+        static uint8_t const END_DIED = 1;
+        static uint8_t const END_STATIC = 2;
+        static uint8_t const END_REPEAT2 = 3;
+        static uint8_t const END_REPEAT3 = 4;
+        static uint8_t const END_POPULATION = 5;
+        static uint8_t const END_GLIDER = 6;
+        static uint8_t const END_CYCLE4 = 7;
+        static uint8_t const END_CYCLE = 8;
+        //Symmetries of random soups
+        static uint8_t const SYMMETRY_NONE = 0;
+        static uint8_t const SYMMETRY_MIRROR_X = 1;     // Left and right halves mirrored
+        static uint8_t const SYMMETRY_MIRROR_Y = 2;     // Top and bottom halves mirrored
+        static uint8_t const SYMMETRY_MIRROR_XY = 3;    // All four quarters mirrored
+        static uint8_t const SYMMETRY_ROTATE_180 = 4;   // Same when turned upside down
+        static uint8_t const NUM_SYMMETRIES = 5;
     protected:
     private:
         static uint8_t const maxRepeatCycle = 24;
         static uint8_t const popHistorySize = 48;
         static uint8_t const CELL_ALIVE = 0x01;
-        static uint8_t const CELL_PREV1 = 0x02;
-        static uint8_t const CELL_PREV2 = 0x04;
-        static uint8_t const CELL_PREV3 = 0x08;
-        static uint8_t const CELL_BIRTH = 0x10;
-        static uint8_t const CELL_DEATH = 0x20;
         int delayms;
         uint8_t fadeSteps;
         RGBMatrixRenderer &renderer;
-        uint8_t** cells; //8bits representing [null,null,deaths,births,prev3,prev2,prev1,alive]
-        uint8_t alive = 0;
-        uint8_t population[popHistorySize] = {};
+        int width;
+        int height;
+        uint8_t* cells; //Rows of cells, each CELL_ALIVE or 0
+        uint8_t* jumpCells; //Grid the next generations are written to by jump, allocated when first used
+        uint8_t* rowBuffers; //Copies of the first row, the row being updated and the one before, and column sums
+        uint32_t* changes[3]; //Indexes of cells changing in this iteration and the previous two, in grid order
+        uint32_t numChanges[3];
+        uint8_t historyLength = 0; //Number of previous iterations in the change lists
+        bool changesApplied = false;
+        bool repeated2 = false; //Grid is the same as 2 iterations ago
+        bool repeated3 = false; //Grid is the same as 3 iterations ago
+        uint32_t alive = 0;
+        uint32_t population[popHistorySize] = {};
         uint8_t popCursor = popHistorySize - 1; //Set to last position as gets incremented before use
-        uint8_t unchangedCount = 0;
-        uint8_t repeat2Count = 0;
-        uint8_t repeat3Count = 0;
-        uint8_t unchangedPopulation[maxRepeatCycle] = {};
+        uint32_t unchangedCount = 0;
+        uint32_t repeat2Count = 0;
+        uint32_t repeat3Count = 0;
+        uint32_t unchangedPopulation[maxRepeatCycle] = {};
         uint32_t iterations = 0;
         uint32_t iterationsMin = 4294967295;
         uint32_t iterationsMax = 0;
-        int panelSize;
+        uint32_t panelSize;
+        uint8_t density = 15; //Percentage of cells alive in random patterns
+        uint8_t symmetry = SYMMETRY_NONE;
+        PatternLoader* patterns = NULL;
+        size_t nextPattern = 0;
+        SoupList* soups = NULL;
+        size_t nextSoup = 0;
+        FrameTimer* timer;      // Phase timer, NULL unless built with FRAME_TIMING
     //functions
     public:
         GameOfLife(RGBMatrixRenderer&,uint8_t,int);
         ~GameOfLife();
         void runCycle();
+        uint32_t advance(uint32_t);
+        void jump(uint32_t);
+        bool isFinished();
+        uint8_t getEndReason();
+        static const char* getEndReasonName(uint8_t);
+        void randomise(uint64_t);
+        void setSoups(SoupList*);
+        void setDensity(uint8_t);
+        void setSymmetry(uint8_t);
+        static const char* getSymmetryName(uint8_t);
+        static uint8_t findSymmetry(const char*);
+        void setPatterns(PatternLoader*);
+        void placePattern(const PatternLoader::Pattern&, int, int, bool=true);
     protected:
     private:
+        friend class GameOfLifeBenchmark; //Times the private phases separately (bench.cpp)
+        struct PlaceContext;
         void initialiseGrid(uint8_t);
-        void applyChanges();
+        void startRun();
+        void resetHistory();
+        void fillRandom(uint64_t);
+        void applySymmetry();
+        void clearCells();
+        void placeCells(const PatternLoader::Pattern&, int, int);
+        static void placeRun(void*, int, int, int);
+        uint32_t getMaxRepeats(uint8_t&);
+        void findChanges();
+        void drawCells();
+        void applyChanges(bool=true);
+        bool pairedUpTo(uint32_t, uint32_t&, uint32_t&);
+        static void stepTile(const uint8_t*, uint8_t*, int, int, int, int);
         void fadeInChanges();
 }; //GameOfLife
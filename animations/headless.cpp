@@ -0,0 +1,228 @@
+/**************************************************************************************************
+ * This is an example to run the animation classes without any display hardware, writing the
+ * frames to stdout or a file as a Y4M video stream or a sequence of PPM images. It does not use
+ * the RGB matrix library, so can be built and run on any machine.
+ *
+ * For example, to make a video of the falling sand animation:
+ *   ./headless -a sand -n 600 | ffmpeg -i - -vf scale=320:320:flags=neighbor sand.mp4
+ *
+ * Written by Paul Fretwell - aka 'Footleg'
+ * 
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <unistd.h>
+#include <getopt.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "HeadlessRenderer.h"
+#include "PatternLoader.h"
+#include "SoupList.h"
+
+#include "golife.h"      //These are the animation classes which can be run
+#include "sparselife.h"
+#include "crawler.h"
+#include "crawlerswarm.h"
+#include "fallingsand.h"
+#include "cellularsand.h"
+
+static int usage(const char *progname) {
+    fprintf(stderr, "usage: %s <options> [optional parameter]\n",
+            progname);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr,
+            "\t-a <name>      : Animation to run (gol, sparse, crawler, swarm, sand, cellsand).\n"
+            "\t-W <pixels>    : Width of display.\n"
+            "\t-H <pixels>    : Height of display.\n"
+            "\t-n <frames>    : Number of frames to write.\n"
+            "\t-o <file>      : Write to file instead of stdout.\n"
+            "\t-p             : Write PPM images instead of Y4M video.\n"
+            "\t-r <fps>       : Frame rate given in Y4M header.\n"
+            "\t-g <number>    : Number of grains, or crawlers for swarm.\n"
+            "\t-l <file>      : Load RLE or Life 1.06 patterns for gol or sparse (can be repeated).\n"
+            "\t--soups <file> : Replay long lived soups saved by the soups program for gol.\n"
+            "\t--symmetry <s> : Symmetry of random soups for gol (none, mirrorx, mirrory, mirrorxy, rotate180).\n"
+            "\t--seed <n>     : Random number seed, to repeat a run.\n");
+
+    fprintf(stderr, "Example:\n\t%s -a sand -n 600 | ffmpeg -i - sand.mp4\n"
+            "Writes 600 frames of falling sand to a video\n", progname);
+    return 1;
+}
+
+
+int main(int argc, char *argv[]) {
+    const char* name = "gol";
+    const char* path = NULL;
+    int width = 32;
+    int height = 32;
+    uint32_t numFrames = 300;
+    uint8_t format = HeadlessRenderer::FORMAT_Y4M;
+    int fps = 30;
+    int number = -1;
+    uint8_t symmetry = GameOfLife::SYMMETRY_NONE;
+
+    unsigned int seed = time(NULL);
+    PatternLoader patterns;
+    SoupList soups(1000);
+
+    static struct option longOptions[] = {
+        { "seed", required_argument, NULL, 'S' },
+        { "soups", required_argument, NULL, 'U' },
+        { "symmetry", required_argument, NULL, 'Y' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "a:W:H:n:o:pr:g:l:", longOptions, NULL)) != -1) {
+        switch (opt) {
+        case 'a':
+        name = optarg;
+        break;
+
+        case 'W':
+        width = atoi(optarg);
+        break;
+
+        case 'H':
+        height = atoi(optarg);
+        break;
+
+        case 'n':
+        numFrames = atoi(optarg);
+        break;
+
+        case 'o':
+        path = optarg;
+        break;
+
+        case 'p':
+        format = HeadlessRenderer::FORMAT_PPM;
+        break;
+
+        case 'r':
+        fps = atoi(optarg);
+        break;
+
+        case 'g':
+        number = atoi(optarg);
+        break;
+
+        case 'l':
+        if (!patterns.load(optarg)) {
+            fprintf(stderr, "Unable to load patterns from %s\n", optarg);
+            return 1;
+        }
+        break;
+
+        case 'S':
+        seed = strtoul(optarg, NULL, 0);
+        break;
+
+        case 'Y':
+        symmetry = GameOfLife::findSymmetry(optarg);
+        if (symmetry == GameOfLife::NUM_SYMMETRIES)
+            return usage(argv[0]);
+        break;
+
+        case 'U':
+        if (!soups.load(optarg)) {
+            fprintf(stderr, "Unable to load soups from %s\n", optarg);
+            return 1;
+        }
+        break;
+
+        default: /* '?' */
+        return usage(argv[0]);
+        }
+    }
+
+    srand(seed);
+
+    if (width < 1 || height < 1)
+        return usage(argv[0]);
+
+    FILE* out = stdout;
+    if (path) {
+        out = fopen(path, "wb");
+        if (out == NULL) {
+            fprintf(stderr, "Unable to open %s\n", path);
+            return 1;
+        }
+    }
+
+    //The renderer flushes the stream as it is destroyed, so it must go before the stream is closed
+    {
+        HeadlessRenderer renderer(width, height, out, format, fps);
+
+        Animator* animation = NULL;
+        if (strcmp(name, "gol") == 0) {
+            GameOfLife* gol = new GameOfLife(renderer, 1, 0);
+            gol->setSymmetry(symmetry);
+            gol->setPatterns(&patterns);
+            gol->setSoups(&soups);
+            animation = gol;
+        }
+        else if (strcmp(name, "sparse") == 0) {
+            SparseLife* life = new SparseLife(renderer);
+            life->setPatterns(&patterns);
+            animation = life;
+        }
+        else if (strcmp(name, "crawler") == 0) {
+            animation = new Crawler(renderer);
+        }
+        else if (strcmp(name, "swarm") == 0) {
+            animation = new CrawlerSwarm(renderer, number < 0 ? 100 : number);
+        }
+        else if (strcmp(name, "sand") == 0) {
+            if (number < 0) number = width * height / 4;
+            FallingSand* sand = new FallingSand(renderer, 0, number);
+            sand->setAcceleration(0, -20);
+            for (int i=0; i<number; i++)
+                sand->addGrain(renderer.random_uint(1, 216));
+            animation = sand;
+        }
+        else if (strcmp(name, "cellsand") == 0) {
+            if (number < 0) number = width * height / 3;
+            CellularSand* sand = new CellularSand(renderer);
+            sand->setAcceleration(0, -1);
+            for (int i=0; i<number; i++) {
+                if (i % 2)
+                    sand->addWater(renderer.random_uint(1, 216));
+                else
+                    sand->addGrain(renderer.random_uint(1, 216));
+            }
+            animation = sand;
+        }
+        else {
+            return usage(argv[0]);
+        }
+
+        //Animators which show their own frames (such as gol) write one frame per show, others get
+        //one frame written per cycle
+        while (renderer.getFrames() < numFrames) {
+            uint32_t frames = renderer.getFrames();
+            animation->runCycle();
+            if (renderer.getFrames() == frames)
+                renderer.showPixels();
+        }
+
+        delete animation;
+    }
+
+    if (path)
+        fclose(out);
+    return 0;
+}
@@ -0,0 +1,278 @@
+/**************************************************************************************************
+ * This is an example to demonstrate using an animation class with the RGB matrix library
+ * from https://github.com/hzeller/rpi-rgb-led-matrix
+ *
+ * Based on the public domain demo example file by Henner Zeller, and extended by
+ * Paul Fretwell - aka 'Footleg' to use the animation classes written by Footleg with the RGBMatrix
+ * library.
+ * 
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <unistd.h>
+#include <getopt.h>
+#include <signal.h>
+
+#include "led-matrix.h"
+#include "threaded-canvas-manipulator.h"
+#include "pixel-mapper.h"
+#include "graphics.h"
+
+#include "golife.h"          //These are the animation classes used to generate each layer
+#include "crawlerswarm.h"
+#include "LayerCompositor.h" //Blends the layers into the frame buffer for the display
+#include "Log.h"
+
+using namespace rgb_matrix;
+
+volatile bool interrupt_received = false;
+static void InterruptHandler(int signo) {
+    interrupt_received = true;
+}
+
+// Animation class passing itself as the output frame buffer renderer into the compositor. Each
+// animator draws to its own layer renderer, and the compositor blends the layers into the frame
+// buffer of this class.
+class Animation : public ThreadedCanvasManipulator, public FrameBufferRenderer {
+    public:
+        Animation(Canvas *m, int width, int height, int delay_ms, int numCrawlers, int decay, int mode, int alpha)
+            : ThreadedCanvasManipulator(m), FrameBufferRenderer{width,height}, delay_ms_(delay_ms), 
+              golLayer(*this), swarmLayer(*this), compositor(*this),
+              life(golLayer,1,delay_ms_), swarm(swarmLayer,numCrawlers)
+        {
+            swarmLayer.setDecay(decay);
+            compositor.addLayer(golLayer, LayerCompositor::BLEND_ADD);
+            compositor.addLayer(swarmLayer, mode, alpha);
+        }
+
+        virtual ~Animation(){
+            logFlush();
+        }
+
+        void Run() {
+            while (running() && !interrupt_received) {
+                life.runCycle();
+                swarm.runCycle();
+                swarmLayer.showPixels();
+                compositor.composite();
+                usleep(delay_ms_ * 1000); // ms
+            }
+        }
+
+        virtual void outputMessage(char msg[]) {
+            fprintf(stderr,msg);
+        }
+        
+        virtual void msSleep(int delay_ms) {
+            usleep(delay_ms * 1000);
+        }
+
+        virtual uint16_t random_uint(uint16_t a, uint16_t b) {
+            return a + rand()%(b-a);
+        }
+
+    protected:
+        virtual void flushPixels() {
+            //Copy frame buffer to the matrix
+            const uint8_t* p = pixels;
+            for (int y=0; y<gridHeight; y++) {
+                for (int x=0; x<gridWidth; x++, p+=3) {
+                    canvas()->SetPixel(x, gridHeight - y - 1, p[0], p[1], p[2]);
+                }
+            }
+        }
+
+    private:
+        int delay_ms_;
+        LayerRenderer golLayer;
+        LayerRenderer swarmLayer;
+        LayerCompositor compositor;
+        GameOfLife life;
+        CrawlerSwarm swarm;
+};
+
+
+static int usage(const char *progname) {
+    fprintf(stderr, "usage: %s <options> [optional parameter]\n",
+            progname);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr,
+            "\t-m <msecs>                : Milliseconds pause between updates.\n"
+            "\t-t <seconds>              : Run for these number of seconds, then exit.\n"
+            "\t-n <number>               : Number of crawlers.\n"
+            "\t-f <amount>               : Fade trails by amount/256 per frame (0=clear trails).\n"
+            "\t-x <mode>                 : Blend crawlers over life (0=add, 1=alpha, 2=max).\n"
+            "\t-a <alpha>                : Opacity of crawler layer (0-255).\n"
+            "\t--seed <number>           : Random number seed, to repeat a run.\n");
+
+    rgb_matrix::PrintMatrixFlags(stderr);
+
+    fprintf(stderr, "Example:\n\t%s -n 50 -x 2 -t 10 \n"
+            "Runs demo for 10 seconds\n", progname);
+    return 1;
+}
+
+
+int main(int argc, char *argv[]) {
+    int runtime_seconds = -1;
+    int scroll_ms = 30;
+    int numCrawlers = 100;
+    int decay = 32;
+    int mode = LayerCompositor::BLEND_ALPHA;
+    int alpha = 255;
+ 
+    unsigned int seed = time(NULL);
+
+    RGBMatrix::Options matrix_options;
+    rgb_matrix::RuntimeOptions runtime_opt;
+
+    // These are the defaults when no command-line flags are given.
+    matrix_options.rows = 32;
+    matrix_options.chain_length = 1;
+    matrix_options.parallel = 1;
+
+    // First things first: extract the command line flags that contain
+    // relevant matrix options.
+    if (!ParseOptionsFromFlags(&argc, &argv, &matrix_options, &runtime_opt)) {
+        return usage(argv[0]);
+    }
+
+    static struct option longOptions[] = {
+        { "seed", required_argument, NULL, 'S' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "dD:t:r:P:c:p:b:m:n:f:x:a:LR:", longOptions, NULL)) != -1) {
+        switch (opt) {
+        case 't':
+        runtime_seconds = atoi(optarg);
+        break;
+
+        case 'm':
+        scroll_ms = atoi(optarg);
+        break;
+
+        case 'n':
+        numCrawlers = atoi(optarg);
+        break;
+
+        case 'f':
+        decay = atoi(optarg);
+        break;
+
+        case 'x':
+        mode = atoi(optarg);
+        break;
+
+        case 'a':
+        alpha = atoi(optarg);
+        break;
+
+        // These used to be options we understood, but deprecated now. Accept
+        // but don't mention in usage()
+        case 'R':
+        fprintf(stderr, "-R is deprecated. "
+                "Use --led-pixel-mapper=\"Rotate:%s\" instead.\n", optarg);
+        return 1;
+        break;
+
+        case 'L':
+        fprintf(stderr, "-L is deprecated. Use\n\t--led-pixel-mapper=\"U-mapper\" --led-chain=4\ninstead.\n");
+        return 1;
+        break;
+
+        case 'd':
+        runtime_opt.daemon = 1;
+        break;
+
+        case 'r':
+        fprintf(stderr, "Instead of deprecated -r, use --led-rows=%s instead.\n",
+                optarg);
+        matrix_options.rows = atoi(optarg);
+        break;
+
+        case 'P':
+        matrix_options.parallel = atoi(optarg);
+        break;
+
+        case 'c':
+        fprintf(stderr, "Instead of deprecated -c, use --led-chain=%s instead.\n",
+                optarg);
+        matrix_options.chain_length = atoi(optarg);
+        break;
+
+        case 'p':
+        matrix_options.pwm_bits = atoi(optarg);
+        break;
+
+        case 'b':
+        matrix_options.brightness = atoi(optarg);
+        break;
+
+        case 'S':
+        seed = strtoul(optarg, NULL, 0);
+        break;
+
+        default: /* '?' */
+        return usage(argv[0]);
+        }
+    }
+
+    srand(seed);
+
+    RGBMatrix *matrix = CreateMatrixFromOptions(matrix_options, runtime_opt);
+    if (matrix == NULL)
+        return 1;
+
+    printf("Size: %dx%d. Hardware gpio mapping: %s\n",
+            matrix->width(), matrix->height(), matrix_options.hardware_mapping);
+
+    Canvas *canvas = matrix;
+
+    // The ThreadedCanvasManipulator objects are filling
+    // the matrix continuously.
+    ThreadedCanvasManipulator *image_gen = NULL;
+    image_gen = new Animation(canvas, canvas->width(), canvas->height(), scroll_ms, numCrawlers, decay, mode, alpha);
+
+    // Set up an interrupt handler to be able to stop animations while they go
+    // on. Note, each demo tests for while (running() && !interrupt_received) {},
+    // so they exit as soon as they get a signal.
+    signal(SIGTERM, InterruptHandler);
+    signal(SIGINT, InterruptHandler);
+
+    // Image generating demo is crated. Now start the thread.
+    image_gen->Start();
+
+    // Now, the image generation runs in the background. We can do arbitrary
+    // things here in parallel. In this demo, we're essentially just
+    // waiting for one of the conditions to exit.
+    if (runtime_seconds > 0) {
+        sleep(runtime_seconds);
+    } else {
+        // The
+        printf("Press <CTRL-C> to exit and reset LEDs\n");
+        while (!interrupt_received) {
+        sleep(1); // Time doesn't really matter. The syscall will be interrupted.
+        }
+    }
+
+    // Stop image generating thread. The delete triggers
+    delete image_gen;
+    delete canvas;
+
+    printf("\%s. Exiting.\n",
+            interrupt_received ? "Received CTRL-C" : "Timeout reached");
+    return 0;
+}
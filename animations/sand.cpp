@@ -21,7 +21,9 @@
  */
 
 #include <unistd.h>
-#include <chrono>
+#include <getopt.h>
+#include <time.h>
+#include <errno.h>
 #include <signal.h>
 
 #include "led-matrix.h"
@@ -30,11 +32,11 @@
 #include "graphics.h"
 
 #include "fallingsand.h" //This is the animation class used to generate output for the display
+#include "RecordingRenderer.h"
+#include "Log.h"
 
 using namespace rgb_matrix;
 
-uint32_t prevTime  = 0;      // Used for frames-per-second throttle
-
 uint8_t backbuffer = 0;      // Index for double-buffered animation
 
 volatile bool interrupt_received = false;
@@ -42,12 +44,21 @@ static void InterruptHandler(int signo) {
     interrupt_received = true;
 }
 
-// Get time stamp in microseconds.
-uint64_t micros()
+// Monotonic clock time in nanoseconds
+static int64_t nanos()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Sleep until an absolute monotonic clock time in nanoseconds
+static void sleepUntil(int64_t deadline)
 {
-    uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::
-                  now().time_since_epoch()).count();
-    return us; 
+    timespec ts;
+    ts.tv_sec = deadline / 1000000000;
+    ts.tv_nsec = deadline % 1000000000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR && !interrupt_received);
 }
 
 // RGB Matrix class which pass itself as a renderer implementation into the GOL class
@@ -55,15 +66,20 @@ uint64_t micros()
 // using the syntax *this
 class Animation : public ThreadedCanvasManipulator, public RGBMatrixRenderer {
     public:
-        Animation(Canvas *m, int width, int height, int delay_ms, int accel_, int shake, int numGrains)
-            : ThreadedCanvasManipulator(m), RGBMatrixRenderer{width,height}, delay_ms_(delay_ms), animation(*this,shake,numGrains), 
-              ax(0), ay(0)
+        Animation(Canvas *m, int width, int height, int delay_ms, int sub_steps, int accel_, int shake, int numGrains,
+                  const char* record_file)
+            : ThreadedCanvasManipulator(m), RGBMatrixRenderer{width,height}, delay_ms_(delay_ms), sub_steps_(sub_steps),
+              recorder(record_file ? new RecordingRenderer(*this,record_file) : NULL),
+              animation(recorder ? *(RGBMatrixRenderer*)recorder : *this,shake,numGrains), ax(0), ay(0)
         {
-            
+            if (delay_ms_ < 1) delay_ms_ = 1;
+            if (sub_steps_ < 1) sub_steps_ = 1;
+
             accel = accel_;
-            counter=1000;
             angle=-1;
-            cycles = 100000;
+            //Change gravity direction every 2.5 seconds of simulated time
+            cycles = 2500 * sub_steps_ / delay_ms_;
+            counter = cycles; //Set first direction on first step
 
             //Create some static pixels
 
@@ -88,62 +104,61 @@ class Animation : public ThreadedCanvasManipulator, public RGBMatrixRenderer {
             }
         }
         
-        virtual ~Animation(){}
+        virtual ~Animation(){
+            logFlush();
+            delete recorder;
+        }
 
         void Run() {
-            uint8_t MAX_FPS=1000/delay_ms_;    // Maximum redraw rate, frames/second
+            // Physics runs on a fixed timestep of sub_steps_ steps per frame period, so the
+            // simulation speed does not depend on how long the grains take to draw. Frames are
+            // presented on absolute deadlines, sleeping for the remainder of each frame period.
+            const int64_t framePeriod = (int64_t)delay_ms_ * 1000000;
+            const int64_t stepPeriod = framePeriod / sub_steps_;
+            const int maxStepsPerFrame = sub_steps_ * 4; // Limit catch up when running slow
+            const int64_t reportPeriod = 5000000000LL;
+
+            int64_t now = nanos();
+            int64_t nextStep = now;
+            int64_t nextFrame = now;
+            int64_t nextReport = now + reportPeriod;
+            uint32_t steps = 0;
+            uint32_t frames = 0;
 
             while (running() && !interrupt_received) {
-                //Update acceleration every 1000 cycles
-                counter++;
-                if (counter > cycles) {
-                    counter = 0;
-                    angle++;
-                    fprintf(stderr,"Angle %d, Accel: %d,%d\n", angle, ax, ay );
-                    switch(angle) {
-                        case 0:
-                            ax = accel;
-                            ay = 0;
-                            break;
-                        case 1:
-                            ax = 0;
-                            ay = -accel;
-                            break;
-                        case 2:
-                            ax = -accel;
-                            ay = 0;
-                            break;
-                        case 3:
-                            ax = 0;
-                            ay = accel;
-                            break;
-                        case 4:
-                            ax = accel;
-                            ay = -accel;
-                            break;
-                        case 5:
-                            ax = -accel;
-                            ay = accel;
-                            angle = -1;
-                            break;
-                    }
-                    animation.setAcceleration(ax,ay);
+                //Run all physics steps which are due, up to the catch up limit
+                int stepsRun = 0;
+                while (nextStep <= now && stepsRun < maxStepsPerFrame) {
+                    stepPhysics();
+                    nextStep += stepPeriod;
+                    stepsRun++;
+                }
+                if (nextStep <= now) {
+                    //Too far behind to catch up, so drop the backlog rather than stall
+                    nextStep = now + stepPeriod;
+                }
+                steps += stepsRun;
+
+                animation.drawPixels();
+                if (recorder)
+                    recorder->showPixels();
+                frames++;
+
+                now = nanos();
+                if (now >= nextReport) {
+                    double secs = (now - nextReport + reportPeriod) / 1e9;
+                    fprintf(stderr, "Physics %.1f steps/s, display %.1f frames/s\n", steps / secs, frames / secs);
+                    steps = 0;
+                    frames = 0;
+                    nextReport = now + reportPeriod;
                 }
 
-
-                
-                animation.runCycle();
-                // Limit the animation frame rate to MAX_FPS.  Because the subsequent sand
-                // calculations are non-deterministic (don't always take the same amount
-                // of time, depending on their current states), this helps ensure that
-                // things like gravity appear constant in the simulation.
-                uint32_t t;
-                
-
-                while((t = micros() - prevTime) < (100000L / MAX_FPS));
-//                fprintf(stderr,"Cycle time: %d\n", t );
-                prevTime = micros();
-                cycles = 2500000 / t;
+                nextFrame += framePeriod;
+                if (nextFrame < now)
+                    nextFrame = now; //Frame overran, so present the next one as soon as possible
+                else
+                    sleepUntil(nextFrame);
+                now = nanos();
             }
         }
 
@@ -169,7 +184,48 @@ class Animation : public ThreadedCanvasManipulator, public RGBMatrixRenderer {
         }
 
     private:
+        //Single physics step, changing gravity direction every 'cycles' steps
+        void stepPhysics() {
+            counter++;
+            if (counter > cycles) {
+                counter = 0;
+                angle++;
+                fprintf(stderr,"Angle %d, Accel: %d,%d\n", angle, ax, ay );
+                switch(angle) {
+                    case 0:
+                        ax = accel;
+                        ay = 0;
+                        break;
+                    case 1:
+                        ax = 0;
+                        ay = -accel;
+                        break;
+                    case 2:
+                        ax = -accel;
+                        ay = 0;
+                        break;
+                    case 3:
+                        ax = 0;
+                        ay = accel;
+                        break;
+                    case 4:
+                        ax = accel;
+                        ay = -accel;
+                        break;
+                    case 5:
+                        ax = -accel;
+                        ay = accel;
+                        angle = -1;
+                        break;
+                }
+                animation.setAcceleration(ax,ay);
+            }
+            animation.stepPhysics();
+        }
+
         int delay_ms_;
+        int sub_steps_;
+        RecordingRenderer* recorder; //Draws to the display through the recorder when recording
         FallingSand animation;
         int16_t ax,ay, accel, angle;
         uint32_t counter, cycles;
@@ -181,11 +237,14 @@ static int usage(const char *progname) {
             progname);
     fprintf(stderr, "Options:\n");
     fprintf(stderr,
-            "\t-m <msecs>     : Milliseconds pause between updates.\n"
+            "\t-m <msecs>     : Milliseconds per displayed frame.\n"
+            "\t-u <steps>     : Physics steps per displayed frame.\n"
             "\t-t <seconds>   : Run for these number of seconds, then exit.\n"
             "\t-n <number>    : Number of grains of sand.\n"
             "\t-g <number>    : Gravity force (0-100 is sensible, but takes higher).\n"
-            "\t-s <number>    : Random shake force (0-100 is sensible, but takes higher).\n");
+            "\t-s <number>    : Random shake force (0-100 is sensible, but takes higher).\n"
+            "\t-o <file>      : Record displayed frames to file (play back with replay).\n"
+            "\t--seed <n>     : Random number seed, to repeat a run.\n");
 
     rgb_matrix::PrintMatrixFlags(stderr);
 
@@ -198,11 +257,13 @@ static int usage(const char *progname) {
 int main(int argc, char *argv[]) {
     int runtime_seconds = -1;
     int scroll_ms = 10;
+    int sub_steps = 10;
     int accel = 0;
     int shake = 0;
     int numGrains = 4;
+    const char* record_file = NULL;
 
-    srand(time(NULL));
+    unsigned int seed = time(NULL);
  
     RGBMatrix::Options matrix_options;
     rgb_matrix::RuntimeOptions runtime_opt;
@@ -218,8 +279,13 @@ int main(int argc, char *argv[]) {
         return usage(argv[0]);
     }
 
+    static struct option longOptions[] = {
+        { "seed", required_argument, NULL, 'S' },
+        { NULL, 0, NULL, 0 }
+    };
+
     int opt;
-    while ((opt = getopt(argc, argv, "dD:t:r:P:g:s:c:n:p:b:m:LR:")) != -1) {
+    while ((opt = getopt_long(argc, argv, "dD:t:r:P:g:s:c:n:p:b:m:u:o:LR:", longOptions, NULL)) != -1) {
         switch (opt) {
         case 't':
         runtime_seconds = atoi(optarg);
@@ -229,6 +295,10 @@ int main(int argc, char *argv[]) {
         scroll_ms = atoi(optarg);
         break;
 
+        case 'u':
+        sub_steps = atoi(optarg);
+        break;
+
         case 'n':
         numGrains = atoi(optarg);
         break;
@@ -241,6 +311,10 @@ int main(int argc, char *argv[]) {
         shake = atoi(optarg);
         break;
 
+        case 'o':
+        record_file = optarg;
+        break;
+
         // These used to be options we understood, but deprecated now. Accept
         // but don't mention in usage()
         case 'R':
@@ -282,11 +356,17 @@ int main(int argc, char *argv[]) {
         matrix_options.brightness = atoi(optarg);
         break;
 
+        case 'S':
+        seed = strtoul(optarg, NULL, 0);
+        break;
+
         default: /* '?' */
         return usage(argv[0]);
         }
     }
 
+    srand(seed);
+
     RGBMatrix *matrix = CreateMatrixFromOptions(matrix_options, runtime_opt);
     if (matrix == NULL)
         return 1;
@@ -299,7 +379,7 @@ int main(int argc, char *argv[]) {
     // The ThreadedCanvasManipulator objects are filling
     // the matrix continuously.
     ThreadedCanvasManipulator *image_gen = NULL;
-    image_gen = new Animation(canvas, canvas->width(), canvas->height(), scroll_ms, accel, shake, numGrains);
+    image_gen = new Animation(canvas, canvas->width(), canvas->height(), scroll_ms, sub_steps, accel, shake, numGrains, record_file);
 
     // Set up an interrupt handler to be able to stop animations while they go
     // on. Note, each demo tests for while (running() && !interrupt_received) {},
@@ -21,6 +21,7 @@
  */
 
 #include <unistd.h>
+#include <getopt.h>
 #include <signal.h>
 
 #include "led-matrix.h"
@@ -29,6 +30,7 @@
 #include "graphics.h"
 
 #include "crawler.h" //This is the animation class used to generate output for the display
+#include "Log.h"
 
 using namespace rgb_matrix;
 
@@ -46,7 +48,9 @@ class Animation : public ThreadedCanvasManipulator, public RGBMatrixRenderer {
             : ThreadedCanvasManipulator(m), RGBMatrixRenderer{width,height}, delay_ms_(delay_ms), animation(*this)
         {}
 
-        virtual ~Animation(){}
+        virtual ~Animation(){
+            logFlush();
+        }
 
         void Run() {
             while (running() && !interrupt_received) {
@@ -88,7 +92,8 @@ static int usage(const char *progname) {
     fprintf(stderr, "Options:\n");
     fprintf(stderr,
             "\t-m <msecs>                : Milliseconds pause between updates.\n"
-            "\t-t <seconds>              : Run for these number of seconds, then exit.\n");
+            "\t-t <seconds>              : Run for these number of seconds, then exit.\n"
+            "\t--seed <number>           : Random number seed, to repeat a run.\n");
 
     rgb_matrix::PrintMatrixFlags(stderr);
 
@@ -102,7 +107,7 @@ int main(int argc, char *argv[]) {
     int runtime_seconds = -1;
     int scroll_ms = 30;
  
-   srand(time(NULL));
+    unsigned int seed = time(NULL);
 
     RGBMatrix::Options matrix_options;
     rgb_matrix::RuntimeOptions runtime_opt;
@@ -118,8 +123,13 @@ int main(int argc, char *argv[]) {
         return usage(argv[0]);
     }
 
+    static struct option longOptions[] = {
+        { "seed", required_argument, NULL, 'S' },
+        { NULL, 0, NULL, 0 }
+    };
+
     int opt;
-    while ((opt = getopt(argc, argv, "dD:t:r:P:c:p:b:m:LR:")) != -1) {
+    while ((opt = getopt_long(argc, argv, "dD:t:r:P:c:p:b:m:LR:", longOptions, NULL)) != -1) {
         switch (opt) {
         case 't':
         runtime_seconds = atoi(optarg);
@@ -170,11 +180,17 @@ int main(int argc, char *argv[]) {
         matrix_options.brightness = atoi(optarg);
         break;
 
+        case 'S':
+        seed = strtoul(optarg, NULL, 0);
+        break;
+
         default: /* '?' */
         return usage(argv[0]);
         }
     }
 
+    srand(seed);
+
     RGBMatrix *matrix = CreateMatrixFromOptions(matrix_options, runtime_opt);
     if (matrix == NULL)
         return 1;
@@ -0,0 +1,336 @@
+/**************************************************************************************************
+ * Soup search for the Game of Life. Runs thousands of random soups without any display, spread
+ * over all the processor cores, and saves the seeds of the longest lived ones. The gol display
+ * program can load the file with --soups to replay them, so the panel shows interesting runs
+ * instead of random soups which die out quickly. It does not use the RGB matrix library, so can
+ * be built and run on any machine.
+ *
+ * Each soup is run with GameOfLife::advance until it dies out or starts repeating, using the same
+ * end conditions as the display, or until the generation limit is reached. Each worker thread
+ * takes soups from its own range of soup numbers, and steals half of the remaining range of
+ * another worker when its own range runs out, so all the cores stay busy to the end of the search
+ * however long the individual soups last.
+ *
+ * For example:
+ *   ./soups -W 64 -H 32 -n 100000 -k 50 -o soups.txt
+ *   sudo ./gol --led-rows=32 --led-cols=64 --soups soups.txt
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <getopt.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "RGBMatrixRenderer.h"
+#include "Log.h"
+#include "SoupList.h"
+
+#include "golife.h"
+
+// Renderer with no output. Soups are seeded by number so don't use its random numbers, apart
+// from picking colours which don't matter here.
+class SoupRenderer : public RGBMatrixRenderer {
+    public:
+        SoupRenderer(int width, int height)
+            : RGBMatrixRenderer(width, height), randomState(1)
+        {}
+
+        virtual ~SoupRenderer() {
+            logFlush();
+        }
+
+        virtual void setPixel(int x, int y, uint8_t r, uint8_t g, uint8_t b) {}
+
+        virtual void showPixels() {}
+
+        virtual void outputMessage(char msg[]) {
+            fputs(msg, stderr);
+        }
+
+        virtual void msSleep(int delay_ms) {}
+
+        //Xorshift generator, as rand() is not thread safe
+        virtual uint16_t random_uint(uint16_t a, uint16_t b) {
+            randomState ^= randomState << 13;
+            randomState ^= randomState >> 17;
+            randomState ^= randomState << 5;
+            return a + randomState % (b - a);
+        }
+
+    private:
+        uint32_t randomState;
+};
+
+// Range of soup numbers still to be run by a worker. Other workers steal from the end of it.
+struct WorkRange {
+    std::mutex lock;
+    uint64_t next;
+    uint64_t end;
+};
+
+struct Search {
+    int width;
+    int height;
+    uint8_t density;
+    uint8_t symmetry;
+    uint32_t maxGenerations;
+    uint64_t baseSeed;
+    int numWorkers;
+    WorkRange* ranges;
+    std::atomic<uint64_t> done;
+    FILE* all;              // Every soup is written here if set
+    std::mutex allLock;
+};
+
+// Seed for soup number n, so soups are spread over all 64 bit seeds
+static uint64_t soupSeed(uint64_t base, uint64_t n)
+{
+    uint64_t z = base + (n + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Take the next soup number from a worker's own range, or steal half of another worker's range
+static bool takeSoup(Search &search, int worker, uint64_t &soup)
+{
+    WorkRange &own = search.ranges[worker];
+    {
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (own.next < own.end) {
+            soup = own.next++;
+            return true;
+        }
+    }
+
+    for (int i=1; i<search.numWorkers; i++) {
+        WorkRange &victim = search.ranges[(worker + i) % search.numWorkers];
+        uint64_t first, end;
+        {
+            std::lock_guard<std::mutex> guard(victim.lock);
+            uint64_t remaining = victim.end - victim.next;
+            if (remaining == 0)
+                continue;
+            first = victim.end - (remaining + 1) / 2;
+            end = victim.end;
+            victim.end = first;
+        }
+        std::lock_guard<std::mutex> guard(own.lock);
+        own.next = first + 1;
+        own.end = end;
+        soup = first;
+        return true;
+    }
+    return false;
+}
+
+static void runWorker(Search &search, int worker, SoupList &best)
+{
+    SoupRenderer renderer(search.width, search.height);
+    GameOfLife gol(renderer, 1, 0);
+    gol.setDensity(search.density);
+    gol.setSymmetry(search.symmetry);
+
+    uint64_t n;
+    while (takeSoup(search, worker, n)) {
+        SoupList::Soup soup;
+        soup.seed = soupSeed(search.baseSeed, n);
+        gol.randomise(soup.seed);
+        soup.lifetime = gol.advance(search.maxGenerations);
+        soup.reason = gol.getEndReason();
+        best.add(soup);
+
+        if (search.all) {
+            std::lock_guard<std::mutex> guard(search.allLock);
+            fprintf(search.all, "%llu,%lu,%u,%s\n", (unsigned long long)soup.seed, (unsigned long)soup.lifetime,
+                    soup.reason, GameOfLife::getEndReasonName(soup.reason));
+        }
+        search.done++;
+    }
+}
+
+static int usage(const char *progname) {
+    fprintf(stderr, "usage: %s <options> [optional parameter]\n",
+            progname);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr,
+            "\t-W <pixels>    : Width of grid, default 32.\n"
+            "\t-H <pixels>    : Height of grid, default 32.\n"
+            "\t-d <percent>   : Percentage of cells alive in each soup, default 15.\n"
+            "\t-s <symmetry>  : Symmetry of soups (none, mirrorx, mirrory, mirrorxy, rotate180), default none.\n"
+            "\t-n <number>    : Number of soups to run, default 10000.\n"
+            "\t-g <number>    : Stop soups which are still running after this many generations, default 100000.\n"
+            "\t-k <number>    : Number of longest lived soups to keep, default 20.\n"
+            "\t-j <number>    : Number of worker threads, default one per core.\n"
+            "\t-o <file>      : File to save the longest lived soups to, default soups.txt.\n"
+            "\t-a <file>      : Also write the result of every soup to a CSV file.\n"
+            "\t--seed <n>     : Random number seed, to repeat a search.\n");
+
+    fprintf(stderr, "Example:\n\t%s -W 64 -H 32 -n 100000 -o soups.txt\n"
+            "Finds the 20 longest lived of 100000 soups on a 64x32 grid\n", progname);
+    return 1;
+}
+
+
+int main(int argc, char *argv[]) {
+    const char* path = "soups.txt";
+    const char* allPath = NULL;
+    uint64_t numSoups = 10000;
+    int keep = 20;
+    int threads = std::thread::hardware_concurrency();
+
+    unsigned int seed = time(NULL);
+
+    Search search;
+    search.width = 32;
+    search.height = 32;
+    search.density = 15;
+    search.symmetry = GameOfLife::SYMMETRY_NONE;
+    search.maxGenerations = 100000;
+    search.all = NULL;
+    search.done = 0;
+
+    static struct option longOptions[] = {
+        { "seed", required_argument, NULL, 'S' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "W:H:d:s:n:g:k:j:o:a:", longOptions, NULL)) != -1) {
+        switch (opt) {
+        case 'W':
+        search.width = atoi(optarg);
+        break;
+
+        case 'H':
+        search.height = atoi(optarg);
+        break;
+
+        case 'd':
+        search.density = atoi(optarg);
+        break;
+
+        case 's':
+        search.symmetry = GameOfLife::findSymmetry(optarg);
+        if (search.symmetry == GameOfLife::NUM_SYMMETRIES)
+            return usage(argv[0]);
+        break;
+
+        case 'n':
+        numSoups = strtoull(optarg, NULL, 0);
+        break;
+
+        case 'g':
+        search.maxGenerations = strtoul(optarg, NULL, 0);
+        break;
+
+        case 'k':
+        keep = atoi(optarg);
+        break;
+
+        case 'j':
+        threads = atoi(optarg);
+        break;
+
+        case 'o':
+        path = optarg;
+        break;
+
+        case 'a':
+        allPath = optarg;
+        break;
+
+        case 'S':
+        seed = strtoul(optarg, NULL, 0);
+        break;
+
+        default: /* '?' */
+        return usage(argv[0]);
+        }
+    }
+
+    if (search.width < 1 || search.height < 1 || keep < 1)
+        return usage(argv[0]);
+    if (threads < 1)
+        threads = 1;
+    search.baseSeed = seed;
+    search.numWorkers = threads;
+
+    if (allPath) {
+        search.all = fopen(allPath, "w");
+        if (search.all == NULL) {
+            fprintf(stderr, "Unable to open %s\n", allPath);
+            return 1;
+        }
+        fprintf(search.all, "seed,generations,reason,description\n");
+    }
+
+    //Split the soups evenly to start with. Workers which finish early steal from the others.
+    search.ranges = new WorkRange[threads];
+    for (int t=0; t<threads; t++) {
+        search.ranges[t].next = numSoups * t / threads;
+        search.ranges[t].end = numSoups * (t + 1) / threads;
+    }
+
+    std::vector<SoupList*> best;
+    std::vector<std::thread> workers;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int t=0; t<threads; t++) {
+        best.push_back(new SoupList(keep));
+        workers.push_back(std::thread(runWorker, std::ref(search), t, std::ref(*best[t])));
+    }
+
+    //Report progress every second while the workers run
+    int ticks = 0;
+    while (search.done < numSoups) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (++ticks % 10 == 0)
+            fprintf(stderr, "%llu of %llu soups run\n", (unsigned long long)search.done.load(),
+                    (unsigned long long)numSoups);
+    }
+    for (int t=0; t<threads; t++)
+        workers[t].join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    //Merge the longest lived soups found by each worker
+    SoupList soups(keep);
+    soups.setGrid(search.width, search.height, search.density);
+    soups.setSymmetry(search.symmetry);
+    for (int t=0; t<threads; t++) {
+        for (size_t i=0; i<best[t]->getCount(); i++)
+            soups.add(best[t]->getSoup(i));
+        delete best[t];
+    }
+    delete [] search.ranges;
+    if (search.all)
+        fclose(search.all);
+
+    if (!soups.save(path)) {
+        fprintf(stderr, "Unable to write %s\n", path);
+        return 1;
+    }
+    fprintf(stderr, "Ran %llu soups in %.1fs on %d threads. Longest lived soup lasted %lu generations.\n",
+            (unsigned long long)numSoups, secs, threads,
+            soups.getCount() ? (unsigned long)soups.getSoup(0).lifetime : 0ul);
+    return 0;
+}
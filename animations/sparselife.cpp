@@ -0,0 +1,470 @@
+/**************************************************************************************************
+ * Sparse Game of Life
+ *
+ * Runs Conway's Game of Life on an unbounded plane, storing only the live cells, and shows a
+ * viewport onto it.
+ *
+ * This implementation was written as a reusable animator class where the RGB matrix hardware
+ * rendering class is passed in, so it can be used with any RGB array display by writing an
+ * implementation of a renderer class to set pixels/LED colours on the hardware.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sparselife.h"
+#include "Log.h"
+
+#include <string.h>
+
+static size_t const minTableSize = 64;
+
+//Position of a pattern being placed, passed to placeRun
+struct SparseLife::PlaceContext {
+    SparseLife* life;
+    int x;
+    int y;
+};
+
+// default constructor
+SparseLife::SparseLife(RGBMatrixRenderer &renderer_)
+    : renderer(renderer_)
+{
+    width = renderer.getGridWidth();
+    height = renderer.getGridHeight();
+    panelSize = (height < width) ? height : width;
+
+    //Start with the plane origin at the top left of the viewport
+    viewX = 0;
+    viewY = 0;
+
+    live.keys = NULL;
+    live.values = NULL;
+    live.capacity = 0;
+    live.count = 0;
+    counts = live;
+    resize(live, minTableSize, false);
+    resize(counts, minTableSize, false);
+} //SparseLife
+
+// default destructor
+SparseLife::~SparseLife()
+{
+    delete [] live.keys;
+    delete [] live.values;
+    delete [] counts.keys;
+    delete [] counts.values;
+} //~SparseLife
+
+void SparseLife::runCycle()
+{
+    if (isFinished())
+    {
+        if (generation > 0)
+        {
+            const char* reason = "Population static";
+            if (live.count == 0)
+                reason = "All died";
+            else if (unchangedCount > 5)
+                reason = "Static pattern for 5 frames";
+            else if (emptyViewCount > panelSize * 4)
+                reason = "Nothing in view";
+            LOG_INFO(renderer, "Pattern terminated after %lu generations with %lu cells: %s\n",
+                     (unsigned long)generation, (unsigned long)live.count, reason);
+        }
+        initialise();
+    }
+
+    step(true);
+
+    if (live.count == 0)
+    {
+        //Pause to show end of population before it gets reset
+        renderer.msSleep(4000);
+    }
+}
+
+//Run up to the given number of generations without drawing them, then draw the viewport. Stops
+//early if the pattern finishes. Returns the number of generations run.
+uint32_t SparseLife::advance(uint32_t generations)
+{
+    uint32_t n = 0;
+    while (n < generations && !isFinished())
+    {
+        step(false);
+        n++;
+    }
+    drawView();
+    return n;
+}
+
+/* The simulation is finished and gets reinitialised when:
+*  - All cells are dead.
+*  - No cells have been born or died for 5 generations (static pattern)
+*  - Nothing has been in the viewport for 4xPanel size generations, such as when the last gliders
+*    have flown away
+*  - The population has stayed the same for 10xPanel size generations, such as oscillators left
+*    behind by gliders heading off across the plane
+*/
+bool SparseLife::isFinished()
+{
+    return live.count == 0 || unchangedCount > 5 || emptyViewCount > panelSize * 4
+        || populationCount > panelSize * 10;
+}
+
+//Start the next loaded pattern, or a random soup filling the viewport if there are none
+void SparseLife::initialise()
+{
+    if (patterns && patterns->getCount() > 0)
+    {
+        if (nextPattern >= patterns->getCount())
+            nextPattern = 0;
+        const PatternLoader::Pattern &pattern = patterns->getPattern(nextPattern++);
+
+        //Set up pattern in the centre of the viewport
+        placePattern(pattern, (width - pattern.width) / 2, (height - pattern.height) / 2);
+    }
+    else
+    {
+        uint64_t seed = 0;
+        for (int i=0; i<4; i++)
+            seed = (seed << 16) | renderer.random_uint(0,65535);
+        LOG_DEBUG(renderer, "Random soup seed %llu\n", (unsigned long long)seed);
+        randomise(seed);
+    }
+}
+
+//Clear the plane and fill the viewport with a random soup. The same seed always gives the same
+//soup for a given viewport size and density.
+void SparseLife::randomise(uint64_t seed)
+{
+    startRun();
+    clearCells();
+
+    uint64_t state = seed;
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            //SplitMix64 generator, so soups do not depend on the renderer random numbers
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            z ^= z >> 31;
+
+            if ( (((z >> 32) * 100) >> 32) < density )
+                setCell((uint32_t)viewX + x, (uint32_t)viewY + height - 1 - y, true);
+        }
+    }
+}
+
+//Reset end condition counters and pick a new colour for the next run
+void SparseLife::startRun()
+{
+    generation = 0;
+    unchangedCount = 0;
+    populationCount = 0;
+    emptyViewCount = 0;
+    renderer.setRandomColour();
+}
+
+//Kill all cells
+void SparseLife::clearCells()
+{
+    memset(live.values, 0, live.capacity);
+    live.count = 0;
+    drawView();
+}
+
+//Set percentage of cells alive when a random soup is generated
+void SparseLife::setDensity(uint8_t percent)
+{
+    density = (percent > 100) ? 100 : percent;
+}
+
+//Use patterns from a loader when the simulation is reset, instead of random soups. The loader
+//must not be deleted while it is in use.
+void SparseLife::setPatterns(PatternLoader* loader)
+{
+    patterns = loader;
+    nextPattern = 0;
+}
+
+//Place a pattern with its top left corner at x,y on the plane, relative to the top left of the
+//viewport. The plane is cleared first and a new run started unless clear is false.
+void SparseLife::placePattern(const PatternLoader::Pattern &pattern, int x, int y, bool clear)
+{
+    if (clear) {
+        startRun();
+        clearCells();
+    }
+    PlaceContext context = { this, (int)((uint32_t)viewX + x), (int)((uint32_t)viewY + y) };
+    PatternLoader::decode(pattern, placeRun, &context);
+}
+
+//Set a run of cells decoded from a pattern alive
+void SparseLife::placeRun(void* context_, int x, int y, int count)
+{
+    PlaceContext &context = *(PlaceContext*)context_;
+    for (int i = 0; i < count; ++i)
+        context.life->setCell((uint32_t)context.x + x + i, (uint32_t)context.y + y, true);
+}
+
+//Set a cell on the plane alive or dead. The y axis counts down the viewport. Coordinates wrap
+//around at the limits of 32 bit integers.
+void SparseLife::setCell(int x, int y, bool alive)
+{
+    uint64_t key = cellKey(x, y);
+    size_t mask = live.capacity - 1;
+    size_t i = findSlot(live, key) - live.values;
+    if (alive == (live.values[i] != 0))
+        return;
+
+    if (alive)
+    {
+        live.keys[i] = key;
+        live.values[i] = 1;
+        if (++live.count * 2 > live.capacity)
+            resize(live, live.capacity * 2, true);
+    }
+    else
+    {
+        //Shift later cells in the probe sequence back over the gap, so they can still be found
+        live.values[i] = 0;
+        live.count--;
+        for (size_t j = (i + 1) & mask; live.values[j] != 0; j = (j + 1) & mask)
+        {
+            size_t home = slotHome(live, live.keys[j]);
+            if (((j - home) & mask) >= ((j - i) & mask))
+            {
+                live.keys[i] = live.keys[j];
+                live.values[i] = live.values[j];
+                live.values[j] = 0;
+                i = j;
+            }
+        }
+    }
+
+    uint32_t gx = (uint32_t)x - (uint32_t)viewX;
+    uint32_t gy = (uint32_t)y - (uint32_t)viewY;
+    if (gx < (uint32_t)width && gy < (uint32_t)height)
+    {
+        if (alive)
+            renderer.setPixel(gx, height - 1 - gy, renderer.r, renderer.g, renderer.b);
+        else
+            renderer.setPixel(gx, height - 1 - gy, 0, 0, 0);
+    }
+}
+
+bool SparseLife::isAlive(int x, int y)
+{
+    return *findSlot(live, cellKey(x, y)) != 0;
+}
+
+//Move the viewport so its top left corner is at x,y on the plane, and redraw it
+void SparseLife::setViewport(int x, int y)
+{
+    viewX = x;
+    viewY = y;
+    drawView();
+}
+
+uint32_t SparseLife::getPopulation()
+{
+    return live.count;
+}
+
+uint32_t SparseLife::getGeneration()
+{
+    return generation;
+}
+
+//Run one generation. Each live cell adds one to the neighbour count of the 8 cells around it and
+//marks its own entry, so only live cells and their neighbours are visited. Cells changing inside
+//the viewport are drawn if draw is set.
+void SparseLife::step(bool draw)
+{
+    //Each live cell touches at most 9 entries
+    if (live.count * 9 * 2 > counts.capacity)
+        resize(counts, live.count * 9 * 2, false);
+    else
+        memset(counts.values, 0, counts.capacity);
+
+    for (size_t i = 0; i < live.capacity; ++i)
+    {
+        if (live.values[i] == 0)
+            continue;
+        uint32_t x = (uint32_t)(live.keys[i] >> 32);
+        uint32_t y = (uint32_t)live.keys[i];
+        for (uint32_t dx = x - 1; dx != x + 2; ++dx)
+        {
+            for (uint32_t dy = y - 1; dy != y + 2; ++dy)
+            {
+                uint64_t key = ((uint64_t)dx << 32) | dy;
+                uint8_t* value = findSlot(counts, key);
+                if (*value == 0)
+                {
+                    counts.keys[value - counts.values] = key;
+                    counts.count++;
+                }
+                //The cell's own entry is marked instead of counted
+                *value += (dx == x && dy == y) ? CELL_SELF : 1;
+            }
+        }
+    }
+
+    //Work out the next state of each cell visited. The counts table is left holding 1 for live
+    //cells and 0 for dead ones, so the live table can be rebuilt from it.
+    uint32_t born = 0;
+    uint32_t died = 0;
+    uint32_t inView = 0;
+    for (size_t i = 0; i < counts.capacity; ++i)
+    {
+        uint8_t value = counts.values[i];
+        if (value == 0)
+            continue;
+        uint8_t neighbours = value & COUNT_MASK;
+        bool wasAlive = (value & CELL_SELF) != 0;
+        bool alive = (neighbours == 3) || (wasAlive && neighbours == 2);
+        counts.values[i] = alive ? 1 : 0;
+
+        uint32_t gx = (uint32_t)(counts.keys[i] >> 32) - (uint32_t)viewX;
+        uint32_t gy = (uint32_t)counts.keys[i] - (uint32_t)viewY;
+        bool visible = gx < (uint32_t)width && gy < (uint32_t)height;
+        if (alive && visible)
+            inView++;
+        if (alive == wasAlive)
+            continue;
+
+        if (alive)
+            born++;
+        else
+            died++;
+        if (draw && visible)
+        {
+            if (alive)
+                renderer.setPixel(gx, height - 1 - gy, renderer.r, renderer.g, renderer.b);
+            else
+                renderer.setPixel(gx, height - 1 - gy, 0, 0, 0);
+        }
+    }
+
+    uint32_t population = live.count + born - died;
+    if (population * 2 > live.capacity)
+        resize(live, population * 2, false);
+    else
+        memset(live.values, 0, live.capacity);
+    for (size_t i = 0; i < counts.capacity; ++i)
+    {
+        if (counts.values[i] == 0)
+            continue;
+        uint8_t* value = findSlot(live, counts.keys[i]);
+        live.keys[value - live.values] = counts.keys[i];
+        *value = 1;
+    }
+
+    //Update end condition counters
+    if (born + died == 0)
+        ++unchangedCount;
+    else
+        unchangedCount = 0;
+    if (born == died)
+        ++populationCount;
+    else
+        populationCount = 0;
+    if (inView == 0)
+        ++emptyViewCount;
+    else
+        emptyViewCount = 0;
+
+    live.count = population;
+    generation++;
+}
+
+//Draw every cell in the viewport
+void SparseLife::drawView()
+{
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+            renderer.setPixel(x, y, 0, 0, 0);
+    }
+    for (size_t i = 0; i < live.capacity; ++i)
+    {
+        if (live.values[i] == 0)
+            continue;
+        uint32_t gx = (uint32_t)(live.keys[i] >> 32) - (uint32_t)viewX;
+        uint32_t gy = (uint32_t)live.keys[i] - (uint32_t)viewY;
+        if (gx < (uint32_t)width && gy < (uint32_t)height)
+            renderer.setPixel(gx, height - 1 - gy, renderer.r, renderer.g, renderer.b);
+    }
+}
+
+//Pack plane coordinates into a table key. Coordinates wrap around at the limits of 32 bit
+//integers, so the plane is really a torus about 4 billion cells across.
+uint64_t SparseLife::cellKey(int x, int y)
+{
+    return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+}
+
+//First slot to look in for a key
+size_t SparseLife::slotHome(const CellTable &table, uint64_t key)
+{
+    uint64_t h = key * 0x9E3779B97F4A7C15ULL;
+    return (size_t)(h ^ (h >> 32)) & (table.capacity - 1);
+}
+
+//Find the value of a key in a table, or the empty slot where it would go. Tables are never more
+//than half full, so the search always ends.
+uint8_t* SparseLife::findSlot(CellTable &table, uint64_t key)
+{
+    size_t mask = table.capacity - 1;
+    size_t i = slotHome(table, key);
+    while (table.values[i] != 0 && table.keys[i] != key)
+        i = (i + 1) & mask;
+    return table.values + i;
+}
+
+//Change the size of a table to at least the given number of slots, keeping the entries if keep is
+//set or leaving it empty otherwise
+void SparseLife::resize(CellTable &table, size_t size, bool keep)
+{
+    size_t capacity = minTableSize;
+    while (capacity < size)
+        capacity *= 2;
+
+    CellTable old = table;
+    table.keys = new uint64_t[capacity];
+    table.values = new uint8_t[capacity];
+    table.capacity = capacity;
+    memset(table.values, 0, capacity);
+
+    if (keep)
+    {
+        for (size_t i = 0; i < old.capacity; ++i)
+        {
+            if (old.values[i] == 0)
+                continue;
+            uint8_t* value = findSlot(table, old.keys[i]);
+            table.keys[value - table.values] = old.keys[i];
+            *value = old.values[i];
+        }
+    }
+    else
+        table.count = 0;
+
+    delete [] old.keys;
+    delete [] old.values;
+}
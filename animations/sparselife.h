@@ -0,0 +1,104 @@
+/**************************************************************************************************
+ * Sparse Game of Life
+ *
+ * Runs Conway's Game of Life on an unbounded plane, storing only the live cells in an open
+ * addressing hash table. Each generation only the live cells and their neighbours are visited, so
+ * the cost depends on the population rather than the size of the universe. This suits patterns
+ * of gliders and spaceships spread over a huge area, which would be almost all empty space on the
+ * torus grid of the GameOfLife class.
+ *
+ * The display shows a viewport onto the plane, the size of the renderer grid. Only cells inside
+ * the viewport which change are drawn. The simulation restarts with the next loaded pattern, or a
+ * random soup filling the viewport, when everything has died or the viewport has been empty for
+ * a while.
+ *
+ * This implementation was written as a reusable animator class where the RGB matrix hardware
+ * rendering class is passed in, so it can be used with any RGB array display by writing an
+ * implementation of a renderer class to set pixels/LED colours on the hardware.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPARSELIFE_H
+#define SPARSELIFE_H
+
+#include "RGBMatrixRenderer.h"
+#include "Animator.h"
+#include "PatternLoader.h"
+
+class SparseLife : public Animator
+{
+    //variables
+    public:
+    protected:
+    private:
+        static uint8_t const CELL_SELF = 0x10;  // Neighbour count entry is for a live cell
+        static uint8_t const COUNT_MASK = 0x0F;
+        //Hash table of cells, keyed on packed coordinates. A value of 0 marks an empty slot.
+        struct CellTable {
+            uint64_t* keys;
+            uint8_t* values;
+            size_t capacity;    // Power of 2
+            size_t count;
+        };
+        RGBMatrixRenderer &renderer;
+        CellTable live;         // Live cells, with value 1
+        CellTable counts;       // Neighbour counts of live cells and the cells next to them
+        int width;              // Size of the viewport, from the renderer grid
+        int height;
+        int viewX;              // Plane coordinates of the top left of the viewport, y counting down
+        int viewY;
+        uint32_t generation = 0;
+        uint32_t unchangedCount = 0;    // Generations with no cells born or dying
+        uint32_t populationCount = 0;   // Generations with the same population
+        uint32_t emptyViewCount = 0;    // Generations with no live cells in the viewport
+        uint32_t panelSize;
+        uint8_t density = 15;   // Percentage of viewport cells alive in random soups
+        PatternLoader* patterns = NULL;
+        size_t nextPattern = 0;
+
+    //functions
+    public:
+        SparseLife(RGBMatrixRenderer&);
+        ~SparseLife();
+        void runCycle();
+        uint32_t advance(uint32_t);
+        bool isFinished();
+        void randomise(uint64_t);
+        void setDensity(uint8_t);
+        void setPatterns(PatternLoader*);
+        void placePattern(const PatternLoader::Pattern&, int, int, bool=true);
+        void setCell(int, int, bool);
+        bool isAlive(int, int);
+        void setViewport(int, int);
+        uint32_t getPopulation();
+        uint32_t getGeneration();
+    protected:
+    private:
+        struct PlaceContext;
+        void initialise();
+        void startRun();
+        void clearCells();
+        void step(bool);
+        void drawView();
+        static void placeRun(void*, int, int, int);
+        static uint64_t cellKey(int, int);
+        static size_t slotHome(const CellTable&, uint64_t);
+        static uint8_t* findSlot(CellTable&, uint64_t);
+        static void resize(CellTable&, size_t, bool);
+}; //SparseLife
+
+#endif
@@ -0,0 +1,98 @@
+/**************************************************************************************************
+ * Host stub of the Arduino core functions used by the sketches in this repo.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Arduino.h"
+
+#include <stdio.h>
+
+HostSerial Serial;
+
+static unsigned long elapsed = 0;   // Time passed in delays, as delays return immediately
+static int analogValue = 0;
+static uint32_t randomState = 1;
+
+void HostSerial::begin(unsigned long baud)
+{
+}
+
+void HostSerial::print(const char* text)
+{
+    fputs(text, stderr);
+}
+
+void HostSerial::print(long n)
+{
+    fprintf(stderr, "%ld", n);
+}
+
+void HostSerial::print(unsigned long n)
+{
+    fprintf(stderr, "%lu", n);
+}
+
+void HostSerial::println(const char* text)
+{
+    fprintf(stderr, "%s\n", text);
+}
+
+void HostSerial::println(long n)
+{
+    fprintf(stderr, "%ld\n", n);
+}
+
+void HostSerial::println(unsigned long n)
+{
+    fprintf(stderr, "%lu\n", n);
+}
+
+void delay(unsigned long ms)
+{
+    elapsed += ms;
+}
+
+unsigned long millis()
+{
+    return elapsed;
+}
+
+int analogRead(uint8_t pin)
+{
+    return analogValue;
+}
+
+void hostSetAnalogValue(int value)
+{
+    analogValue = value;
+}
+
+void randomSeed(unsigned long seed)
+{
+    randomState = seed ? seed : 1;
+}
+
+//Xorshift generator, so runs repeat on any host
+long random(long lowest, long highest)
+{
+    if (highest <= lowest)
+        return lowest;
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return lowest + randomState % (highest - lowest);
+}
@@ -0,0 +1,59 @@
+/**************************************************************************************************
+ * Host stub of the Arduino core functions used by the sketches in this repo, so they can be
+ * built and run on a PC for testing. Serial output goes to stderr, delays return immediately and
+ * random numbers come from a fixed generator seeded with the value returned by analogRead.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+class HostSerial
+{
+    //functions
+    public:
+        void begin(unsigned long);
+        void print(const char*);
+        void print(long);
+        void print(unsigned long);
+        void print(int n) { print((long)n); }
+        void print(unsigned int n) { print((unsigned long)n); }
+        void print(unsigned char n) { print((unsigned long)n); }
+        void println(const char*);
+        void println(long);
+        void println(unsigned long);
+        void println(int n) { println((long)n); }
+        void println(unsigned int n) { println((unsigned long)n); }
+        void println(unsigned char n) { println((unsigned long)n); }
+        operator bool() { return true; }
+}; //HostSerial
+
+extern HostSerial Serial;
+
+void delay(unsigned long);
+unsigned long millis();
+int analogRead(uint8_t);
+void randomSeed(unsigned long);
+long random(long, long);
+
+//Set the value analogRead returns, which the sketches use as their random seed
+void hostSetAnalogValue(int);
+
+#endif
@@ -0,0 +1,64 @@
+/**************************************************************************************************
+ * Host stub of the parts of the FastLED library used by the sketches in this repo: the CRGB
+ * colour type and its named colours.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FASTLED_H
+#define FASTLED_H
+
+#include "Arduino.h"
+
+struct CRGB
+{
+    union {
+        struct {
+            uint8_t r;
+            uint8_t g;
+            uint8_t b;
+        };
+        struct {
+            uint8_t red;
+            uint8_t green;
+            uint8_t blue;
+        };
+        uint8_t raw[3];
+    };
+
+    enum HTMLColorCode {
+        Black = 0x000000,
+        Blue = 0x0000FF,
+        Cyan = 0x00FFFF,
+        Green = 0x008000,
+        Orange = 0xFFA500,
+        Purple = 0x800080,
+        Red = 0xFF0000,
+        White = 0xFFFFFF,
+        Yellow = 0xFFFF00
+    };
+
+    CRGB() {}
+
+    CRGB(HTMLColorCode colour)
+    {
+        r = (colour >> 16) & 0xFF;
+        g = (colour >> 8) & 0xFF;
+        b = colour & 0xFF;
+    }
+};
+
+#endif
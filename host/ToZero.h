@@ -0,0 +1,8 @@
+/**************************************************************************************************
+ * Host stub of the ToZero adapter library. Nothing from it is needed on a PC.
+ */
+
+#ifndef TOZERO_H
+#define TOZERO_H
+
+#endif
@@ -0,0 +1,81 @@
+/**************************************************************************************************
+ * Host stub of the Unicorn HAT HD display class.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UnicornHD.h"
+
+// default constructor
+UnicornHD::UnicornHD()
+    : brightness(255), frames(0), checksum(0xCBF29CE484222325ULL), text(NULL)
+{
+    for (int i=0; i<WIDTH * HEIGHT; i++)
+        pixels[i] = CRGB::Black;
+} //UnicornHD
+
+void UnicornHD::Begin()
+{
+}
+
+void UnicornHD::SetBrightness(uint8_t brightness_)
+{
+    brightness = brightness_;
+}
+
+//Pixels from the top left, row by row
+CRGB* UnicornHD::Pixels()
+{
+    return pixels;
+}
+
+//Add the frame to the checksum (FNV-1a), and draw it if text output is set
+void UnicornHD::Show()
+{
+    for (int i=0; i<WIDTH * HEIGHT; i++) {
+        for (int c=0; c<3; c++) {
+            checksum ^= pixels[i].raw[c];
+            checksum *= 0x100000001B3ULL;
+        }
+    }
+    frames++;
+
+    if (text) {
+        fprintf(text, "Frame %lu\n", (unsigned long)frames);
+        for (int y=0; y<HEIGHT; y++) {
+            for (int x=0; x<WIDTH; x++) {
+                const CRGB &p = pixels[y * WIDTH + x];
+                fputc((p.r | p.g | p.b) ? '#' : '.', text);
+            }
+            fputc('\n', text);
+        }
+    }
+}
+
+uint32_t UnicornHD::getFrames()
+{
+    return frames;
+}
+
+uint64_t UnicornHD::getChecksum()
+{
+    return checksum;
+}
+
+void UnicornHD::setTextOutput(FILE* file)
+{
+    text = file;
+}
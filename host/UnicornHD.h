@@ -0,0 +1,56 @@
+/**************************************************************************************************
+ * Host stub of the Unicorn HAT HD display class. Each frame shown is added to a checksum, so runs
+ * can be compared between builds, and can also be drawn as text.
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UNICORNHD_H
+#define UNICORNHD_H
+
+#include <stdio.h>
+
+#include "FastLED.h"
+
+class UnicornHD
+{
+    //variables
+    public:
+        static uint8_t const WIDTH = 16;
+        static uint8_t const HEIGHT = 16;
+    protected:
+    private:
+        CRGB pixels[WIDTH * HEIGHT];
+        uint8_t brightness;
+        uint32_t frames;
+        uint64_t checksum;
+        FILE* text;             // Frames are drawn here as text if set
+
+    //functions
+    public:
+        UnicornHD();
+        void Begin();
+        void SetBrightness(uint8_t);
+        CRGB* Pixels();
+        void Show();
+        uint32_t getFrames();
+        uint64_t getChecksum();
+        void setTextOutput(FILE*);
+    protected:
+    private:
+}; //UnicornHD
+
+#endif
@@ -0,0 +1,91 @@
+/**************************************************************************************************
+ * Runs the GOL.cpp Teensy sketch on a PC, using host stubs of the Arduino, FastLED and Unicorn
+ * HAT HD libraries. Calls setup and then loop until the number of frames has been shown, then
+ * prints a checksum of all the frames so runs can be compared between builds.
+ *
+ * For example:
+ *   make -C host && host/gol_host -n 2000 --seed 1
+ *
+ * Copyright (C) 2020 Paul Fretwell - aka 'Footleg'
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "Arduino.h"
+#include "UnicornHD.h"
+
+//Sketch functions and display
+void setup();
+void loop();
+extern UnicornHD unicorn;
+
+static int usage(const char *progname) {
+    fprintf(stderr, "usage: %s <options> [optional parameter]\n",
+            progname);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr,
+            "\t-n <frames>    : Number of frames to run, default 1000.\n"
+            "\t-t             : Draw each frame as text on stdout.\n"
+            "\t--seed <n>     : Random number seed, to repeat a run.\n");
+
+    fprintf(stderr, "Example:\n\t%s -n 2000 --seed 1\n"
+            "Runs 2000 frames and prints their checksum\n", progname);
+    return 1;
+}
+
+
+int main(int argc, char *argv[]) {
+    uint32_t numFrames = 1000;
+    unsigned int seed = time(NULL);
+
+    static struct option longOptions[] = {
+        { "seed", required_argument, NULL, 'S' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "n:t", longOptions, NULL)) != -1) {
+        switch (opt) {
+        case 'n':
+        numFrames = strtoul(optarg, NULL, 0);
+        break;
+
+        case 't':
+        unicorn.setTextOutput(stdout);
+        break;
+
+        case 'S':
+        seed = strtoul(optarg, NULL, 0);
+        break;
+
+        default: /* '?' */
+        return usage(argv[0]);
+        }
+    }
+
+    //The sketch seeds its random numbers from an analog input
+    hostSetAnalogValue(seed);
+    setup();
+    while (unicorn.getFrames() < numFrames)
+        loop();
+
+    printf("%lu frames, %lu ms, checksum %016llx\n", (unsigned long)unicorn.getFrames(), millis(),
+           (unsigned long long)unicorn.getChecksum());
+    return 0;
+}